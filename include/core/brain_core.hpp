@@ -28,6 +28,9 @@ public:
         timeout_match,
         max_memory,
         time_left,
+        threads,
+        ponder,
+        proof,
         game_type,
         rule,
         folder,
@@ -66,6 +69,24 @@ public:
     // delete temporary files, free resources
     virtual void brainEnd() = 0;
 
+    //! CAN BE IMPLEMENTED BY THE BRAIN
+
+    // prepare a search on the opponent time after our move, called with the thinking lock held, return false to wait idle
+    virtual bool brainPonderStart()
+    {
+        return false;
+    }
+
+    // search on the opponent time, return when the search is done or aborted by brainPonderStop()
+    virtual void brainPonder()
+    {
+    }
+
+    // abort the search of brainPonder(), called from the command thread with the thinking lock held
+    virtual void brainPonderStop()
+    {
+    }
+
     //! BUILT-IN FUNCTIONS
 
     // core
@@ -80,6 +101,8 @@ public:
     void stopThinkingThread();
     void thinkingThread();
     void startThinking();
+    void stopPondering();
+    void stopPondering(std::unique_lock<std::mutex> &lock);
 
     // callbacks
     void doMyMove(std::uint32_t x, std::uint32_t y);
@@ -103,8 +126,16 @@ protected:
 
     bool m_thinking_thread_running;
     std::thread m_thinking_thread;
+    // protects the flags below, and the brain between the commands and the ponder search
+    std::mutex m_thinking_mutex;
     std::condition_variable m_need_thinking_cond;
     std::condition_variable m_start_thinking_cond;
+    std::condition_variable m_ponder_cond;
+    bool m_thinking_thread_started;
+    // a move has been received and is not searched yet
+    bool m_need_thinking;
+    // the thinking thread is in brainPonder()
+    bool m_pondering;
 
     Config m_config;
 
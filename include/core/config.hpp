@@ -17,6 +17,13 @@ struct Config {
     std::uint32_t timeout_match;
     std::uint32_t max_memory;
     std::uint32_t time_left;
+    // number of search threads
+    std::uint32_t threads;
+    // search on the opponent time, between our move and the next command (INFO ponder 1), off by default as some
+    // managers forbid it
+    bool ponder;
+    // try to prove each position won or lost on half of the turn before the heuristic search (INFO proof 1)
+    bool proof;
     enum class GameType {
         human_opponent,
         ai_opponent,
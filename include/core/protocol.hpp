@@ -37,6 +37,9 @@ enum class IncomingVerb {
     info_timeout_match,
     info_max_memory,
     info_time_left,
+    info_threads,
+    info_ponder,
+    info_proof,
     info_game_type,
     info_rule,
     info_evaluate,
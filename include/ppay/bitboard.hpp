@@ -0,0 +1,196 @@
+/**
+ * @file bitboard.hpp
+ * @brief Fixed capacity bitset holding one bit per board cell
+ */
+
+#ifndef PPAY_BITBOARD_HPP
+#define PPAY_BITBOARD_HPP
+
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace gmk::ppay {
+
+// biggest board side supported by the bitboards
+#define MAX_BOARD_SIZE 32
+// each row is followed by one always empty sentinel column
+#define MAX_BOARD_STRIDE (MAX_BOARD_SIZE + 1)
+// number of 64-bit words needed to store the biggest padded board
+#define BITBOARD_WORDS ((MAX_BOARD_STRIDE * MAX_BOARD_SIZE + 63) / 64)
+#define BITBOARD_BITS (BITBOARD_WORDS * 64)
+
+/**
+ * Index of the least significant set bit, word must not be 0.
+ */
+static inline int lowestBit(std::uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+/**
+ * Number of set bits of a word.
+ */
+static inline int bitCount(std::uint64_t word)
+{
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+class Bitboard {
+public:
+    /**
+     * Default constructor, build an empty bitboard.
+     */
+    Bitboard()
+        : m_words {}
+    {
+    }
+
+    /**
+     * Indicates whether a bit is set, out of range bits are never set.
+     *
+     * @param index: index of the bit.
+     */
+    inline bool test(int index) const
+    {
+        if (static_cast<unsigned>(index) >= BITBOARD_BITS)
+            return false;
+        return (m_words[index >> 6] >> (index & 63)) & 1;
+    }
+
+    inline void set(int index)
+    {
+        m_words[index >> 6] |= std::uint64_t(1) << (index & 63);
+    }
+
+    inline void reset(int index)
+    {
+        m_words[index >> 6] &= ~(std::uint64_t(1) << (index & 63));
+    }
+
+    inline bool any() const
+    {
+        std::uint64_t acc = 0;
+        for (int i = 0; i < BITBOARD_WORDS; i++)
+            acc |= m_words[i];
+        return acc != 0;
+    }
+
+    inline int count() const
+    {
+        int count = 0;
+        for (int i = 0; i < BITBOARD_WORDS; i++)
+            count += bitCount(m_words[i]);
+        return count;
+    }
+
+    /**
+     * Index of the lowest set bit, the bitboard must not be empty.
+     */
+    inline int first() const
+    {
+        int i = 0;
+        while (!m_words[i])
+            i++;
+        return (i << 6) + lowestBit(m_words[i]);
+    }
+
+    inline std::uint64_t word(int index) const
+    {
+        return m_words[index];
+    }
+
+    /**
+     * Calls f(index) for each set bit, in increasing order.
+     */
+    template <typename F>
+    inline void forEach(F f) const
+    {
+        for (int i = 0; i < BITBOARD_WORDS; i++) {
+            std::uint64_t word = m_words[i];
+            while (word) {
+                f((i << 6) + lowestBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    /**
+     * Shift towards lower indexes: bit i of the result is bit i + n of this bitboard.
+     * Used to align the cells of a line direction (1 = horizontal, stride = vertical,
+     * stride + 1 = diagonal, stride - 1 = anti-diagonal).
+     */
+    Bitboard operator>>(int n) const
+    {
+        Bitboard result;
+        int wordShift = n >> 6;
+        int bitShift = n & 63;
+
+        for (int i = 0; i + wordShift < BITBOARD_WORDS; i++) {
+            std::uint64_t low = m_words[i + wordShift] >> bitShift;
+            std::uint64_t high = (bitShift && i + wordShift + 1 < BITBOARD_WORDS) ? m_words[i + wordShift + 1] << (64 - bitShift) : 0;
+            result.m_words[i] = low | high;
+        }
+        return result;
+    }
+
+    inline Bitboard operator&(const Bitboard &other) const
+    {
+        Bitboard result;
+        for (int i = 0; i < BITBOARD_WORDS; i++)
+            result.m_words[i] = m_words[i] & other.m_words[i];
+        return result;
+    }
+
+    inline Bitboard operator|(const Bitboard &other) const
+    {
+        Bitboard result;
+        for (int i = 0; i < BITBOARD_WORDS; i++)
+            result.m_words[i] = m_words[i] | other.m_words[i];
+        return result;
+    }
+
+    inline Bitboard &operator&=(const Bitboard &other)
+    {
+        for (int i = 0; i < BITBOARD_WORDS; i++)
+            m_words[i] &= other.m_words[i];
+        return *this;
+    }
+
+    inline Bitboard &operator|=(const Bitboard &other)
+    {
+        for (int i = 0; i < BITBOARD_WORDS; i++)
+            m_words[i] |= other.m_words[i];
+        return *this;
+    }
+
+    inline bool operator==(const Bitboard &other) const
+    {
+        for (int i = 0; i < BITBOARD_WORDS; i++)
+            if (m_words[i] != other.m_words[i])
+                return false;
+        return true;
+    }
+
+    inline bool operator!=(const Bitboard &other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    std::uint64_t m_words[BITBOARD_WORDS];
+};
+}
+
+#endif /* PPAY_BITBOARD_HPP */
@@ -0,0 +1,281 @@
+/**
+ * @file move_picker.hpp
+ * @brief Moves of a search node, generated lazily from the most to the least promising
+ */
+
+#ifndef PPAY_MOVE_PICKER_HPP
+#define PPAY_MOVE_PICKER_HPP
+
+#include <cstdint>
+
+#include "position.hpp"
+
+namespace gmk::ppay {
+
+// number of killer moves kept for each ply
+#define NB_KILLERS 2
+
+// groups of moves given by the picker, in order
+enum class PickStage : std::uint8_t {
+    // best move stored in the transposition table
+    ttMove,
+    // cells making a five
+    wins,
+    // cells stopping a five of the opponent, or a four against a three
+    blocks,
+    // cells making a four or a three
+    threats,
+    // moves which made a cutoff at the same ply
+    killers,
+    // scoring of the other candidates
+    quietInit,
+    // other candidates, best score first
+    quiet,
+    done,
+};
+
+/**
+ * Candidate given after the killers, with the keys ordering it.
+ */
+struct QuietMove {
+    Move move;
+    // sum of the threats of both players on the cell
+    int threat;
+    int history;
+};
+
+/**
+ * Gives the moves of a node one at a time, each stage being generated only when the previous ones are exhausted:
+ * a cutoff on an early move skips the generation and the scoring of the quiet moves.
+ *
+ * Against a five only the five cells are given, and against a three only the cells where one of the players
+ * makes a four: the other moves lose at once.
+ */
+class MovePicker {
+public:
+    /**
+     * @param pos: position of the node, it may change between two calls of next() but must be restored before each of them.
+     * @param ttMove: best move of the transposition table, (-1, -1) if none.
+     * @param killers: NB_KILLERS killer moves of the ply.
+     * @param history: history scores of the player to move, indexed by x + y * MAX_BOARD_SIZE.
+     * @param quiets: room for as many moves as the cells of the board, the quiet moves are scored there, kept by the
+     * caller so the picker stays small on the stack of the search.
+     */
+    MovePicker(const Position &pos, const Move &ttMove, const Move *killers, const int *history, QuietMove *quiets)
+        : m_pos(pos)
+        , m_ttMove(ttMove)
+        , m_killers(killers)
+        , m_history(history)
+        , m_quiets(quiets)
+        , m_stage(PickStage::ttMove)
+        , m_isMyTurn(pos.isMyTurn())
+        , m_nbQuiets(0)
+        , m_step(0)
+    {
+        m_forced = pos.getThreatCells(!m_isMyTurn, ThreatType::five).any();
+        m_mustDefend = !m_forced && pos.getThreatCells(!m_isMyTurn, ThreatType::openFour).any();
+    }
+
+    /**
+     * Next move to search.
+     *
+     * @param move: set to the move.
+     * @return false when all the moves have been given.
+     */
+    bool next(Move &move)
+    {
+        while (true) {
+            switch (m_stage) {
+            case PickStage::ttMove:
+                // the fives are given next even after the tt move, it is skipped among them if it is one
+                m_stage = PickStage::wins;
+                startCells(m_pos.getThreatCells(m_isMyTurn, ThreatType::five));
+                if (pick(m_ttMove)) {
+                    move = m_ttMove;
+                    return true;
+                }
+                break;
+
+            case PickStage::wins:
+                if (nextCell(move))
+                    return true;
+                m_stage = PickStage::blocks;
+                m_step = 0;
+                startCells(m_pos.getThreatCells(!m_isMyTurn, ThreatType::five));
+                break;
+
+            case PickStage::blocks:
+                if (nextCell(move))
+                    return true;
+                // against a three, its open four cells first, then the cells leaving it a four only
+                if (m_mustDefend && m_step < 2) {
+                    startCells(m_pos.getThreatCells(!m_isMyTurn, m_step == 0 ? ThreatType::openFour : ThreatType::four));
+                    m_step++;
+                    break;
+                }
+                if (m_forced) {
+                    m_stage = PickStage::done;
+                    break;
+                }
+                m_stage = PickStage::threats;
+                m_step = 0;
+                break;
+
+            case PickStage::threats:
+                if (nextCell(move))
+                    return true;
+                // from the strongest threat, without the threes against a three
+                if (m_step < (m_mustDefend ? 2 : 3)) {
+                    static const ThreatType threats[] = { ThreatType::openFour, ThreatType::four, ThreatType::openThree };
+                    startCells(m_pos.getThreatCells(m_isMyTurn, threats[m_step]));
+                    m_step++;
+                    break;
+                }
+                m_stage = PickStage::killers;
+                m_step = 0;
+                break;
+
+            case PickStage::killers:
+                while (m_step < NB_KILLERS) {
+                    const Move &killer = m_killers[m_step++];
+                    if (pick(killer)) {
+                        move = killer;
+                        return true;
+                    }
+                }
+                m_stage = m_mustDefend ? PickStage::done : PickStage::quietInit;
+                break;
+
+            case PickStage::quietInit:
+                scoreQuiets();
+                m_stage = PickStage::quiet;
+                break;
+
+            case PickStage::quiet:
+                if (nextQuiet(move))
+                    return true;
+                m_stage = PickStage::done;
+                break;
+
+            case PickStage::done:
+                return false;
+            }
+        }
+    }
+
+    /**
+     * Indicates whether the last move given is a quiet move, neither a threat nor a killer.
+     */
+    inline bool isQuiet() const
+    {
+        return m_stage == PickStage::quiet;
+    }
+
+private:
+    /**
+     * Indicates whether a move outside of the bitboard stages is searched, and marks it as given.
+     */
+    bool pick(const Move &move)
+    {
+        if (move.first < 0 || move.first >= m_pos.getWidth() || move.second < 0 || move.second >= m_pos.getHeight())
+            return false;
+
+        int index = m_pos.getIndex(move.first, move.second);
+        if (m_picked.test(index) || !m_pos.getCandidates().test(index))
+            return false;
+        if (m_forced) {
+            if (!m_pos.getThreatCells(m_isMyTurn, ThreatType::five).test(index) && !m_pos.getThreatCells(!m_isMyTurn, ThreatType::five).test(index))
+                return false;
+        } else if (m_mustDefend) {
+            if (m_pos.getThreat(move.first, move.second, m_isMyTurn) < ThreatType::four
+                && m_pos.getThreat(move.first, move.second, !m_isMyTurn) < ThreatType::four)
+                return false;
+        }
+        m_picked.set(index);
+        return true;
+    }
+
+    inline void startCells(const Bitboard &cells)
+    {
+        m_cells = cells;
+    }
+
+    /**
+     * Next cell of the current bitboard which was not given yet.
+     */
+    bool nextCell(Move &move)
+    {
+        while (m_cells.any()) {
+            int index = m_cells.first();
+            m_cells.reset(index);
+            if (m_picked.test(index))
+                continue;
+            m_picked.set(index);
+            move = m_pos.getCell(index);
+            return true;
+        }
+        return false;
+    }
+
+    void scoreQuiets()
+    {
+        m_nbQuiets = 0;
+        for (int i = 0; i < m_pos.getNbCandidates(); i++) {
+            Move move = m_pos.getCandidate(i);
+            if (m_picked.test(m_pos.getIndex(move.first, move.second)))
+                continue;
+            int threat = static_cast<int>(m_pos.getThreat(move.first, move.second, m_isMyTurn))
+                + static_cast<int>(m_pos.getThreat(move.first, move.second, !m_isMyTurn));
+            m_quiets[m_nbQuiets++] = { move, threat, m_history[move.first + move.second * MAX_BOARD_SIZE] };
+        }
+    }
+
+    /**
+     * Best remaining quiet move, selected without sorting the others.
+     */
+    bool nextQuiet(Move &move)
+    {
+        if (m_nbQuiets == 0)
+            return false;
+
+        int best = 0;
+        for (int i = 1; i < m_nbQuiets; i++)
+            if (isBetter(m_quiets[i], m_quiets[best]))
+                best = i;
+        move = m_quiets[best].move;
+        m_quiets[best] = m_quiets[--m_nbQuiets];
+        return true;
+    }
+
+    static inline bool isBetter(const QuietMove &a, const QuietMove &b)
+    {
+        if (a.threat != b.threat)
+            return a.threat > b.threat;
+        if (a.history != b.history)
+            return a.history > b.history;
+        return a.move < b.move;
+    }
+
+    const Position &m_pos;
+    Move m_ttMove;
+    const Move *m_killers;
+    const int *m_history;
+    QuietMove *m_quiets;
+
+    PickStage m_stage;
+    bool m_isMyTurn;
+    // the opponent makes a five unless it is blocked
+    bool m_forced;
+    // the opponent makes an open four unless it is blocked or a four is played
+    bool m_mustDefend;
+    // moves already given
+    Bitboard m_picked;
+    // cells left of the current bitboard stage
+    Bitboard m_cells;
+    int m_nbQuiets;
+    // index of the bitboard or the killer in the current stage
+    int m_step;
+};
+}
+
+#endif /* PPAY_MOVE_PICKER_HPP */
@@ -7,14 +7,38 @@
 #define PPAY_POSITION_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 
+#include "bitboard.hpp"
+#include "threat.hpp"
+#include "zobrist.hpp"
+
 namespace gmk::ppay {
 
 #define LOSE_RATIO 2
 
-static const int heuristicResults[] = {
+// number of symmetries of a square board (flips and rotations)
+#define NB_SYMMETRIES 8
+
+// a cell of the board (x, y)
+using Move = std::pair<int, int>;
+
+// empty cells at most CANDIDATE_RADIUS cells away from a stone, horizontally and vertically, are the candidate moves
+#define CANDIDATE_RADIUS 2
+
+// empty bits before the first line and after each line, so the cells read around a cell (at most LINE_PADDING cells away)
+// are inside the layout and never in another line
+#define LINE_PADDING 8
+// bits of a line in the line layouts (see Position::lineIndex()), the cells of the line then its padding
+#define LINE_SIZE (MAX_BOARD_SIZE + LINE_PADDING)
+// lines of a direction in the line layouts, as many as the diagonals of the biggest board
+#define NB_LINES (2 * MAX_BOARD_SIZE - 1)
+// 64-bit words of a line layout, one more word is read past the last cell
+#define LINE_WORDS ((LINE_PADDING + NB_LINES * LINE_SIZE + LINE_PADDING + 63) / 64 + 1)
+
+static constexpr int heuristicResults[] = {
     /* ..... */ 0,
     /* 1.... */ 1,
     /* 2.... */ LOSE_RATIO * -1,
@@ -260,54 +284,95 @@ static const int heuristicResults[] = {
     /* 22222 */ LOSE_RATIO * -1000000,
 };
 
+/**
+ * Score of a five cells window, indexed by the bits of my stones and by the bits of the opponent stones
+ * (bit k is the k-th cell of the window). Built once from heuristicResults.
+ */
+struct WindowScores {
+    int scores[32][32];
+
+    WindowScores()
+        : scores {}
+    {
+        for (int me = 0; me < 32; me++) {
+            for (int opponent = 0; opponent < 32; opponent++) {
+                if (me & opponent)
+                    continue;
+                int index = 0;
+                for (int k = 4; k >= 0; k--)
+                    index = index * 3 + (((me >> k) & 1) ? 1 : ((opponent >> k) & 1) ? 2 : 0);
+                scores[me][opponent] = heuristicResults[index];
+            }
+        }
+    }
+};
+
+inline const WindowScores windowScores;
+
+/**
+ * State overwritten by a move, saved by Position::makeMove() to be restored by Position::unmakeMove().
+ */
+struct UndoEntry {
+    // bit index of the played cell
+    int index;
+    // bounding box before the move
+    int minX;
+    int minY;
+    int maxX;
+    int maxY;
+    // player who played the move
+    bool isMyTurn;
+};
+
 class Position {
 public:
     /**
      * Default constructor, build an empty position.
+     * The board must not be bigger than MAX_BOARD_SIZE x MAX_BOARD_SIZE.
      */
     Position(int width, int height)
         : m_width { width }
         , m_height { height }
         , m_nbCells { width * height }
+        , m_stride { width + 1 }
+        , m_shifts { 1, width + 1, width + 2, width }
+        , m_lineStones {}
+        , m_lineOnBoard {}
         , m_minX { width - 1 }
         , m_minY { height - 1 }
         , m_maxX { 0 }
         , m_maxY { 0 }
         , m_nbMoves { 0 }
         , m_isMyTurn { true }
+        , m_undoSize { 0 }
+        , m_hashes {}
+        , m_score { 0 }
+        , m_nbNear {}
+        , m_nbCandidates { 0 }
+        , m_runs {}
+        , m_threats {}
     {
-        // init int **m_board with 0
-        m_board = new int[m_nbCells];
-        std::fill(m_board, m_board + m_nbCells, 0);
-    }
+        // the sentinel column at the end of each row is never on board
+        for (int y = 0; y < m_height; y++) {
+            for (int x = 0; x < m_width; x++) {
+                m_onBoard.set(x + y * m_stride);
+                for (int d = 0; d < 4; d++)
+                    toggleLineBit(m_lineOnBoard[d], lineIndex(d, x, y));
+            }
+        }
 
-    /**
-     * Destructor, delete the board.
-     */
-    ~Position()
-    {
-        delete[] m_board;
+        // a window can start on a cell if its five cells are on board
+        for (int d = 0; d < 4; d++) {
+            m_windowStarts[d] = m_onBoard;
+            for (int k = 1; k < 5; k++)
+                m_windowStarts[d] &= m_onBoard >> (k * m_shifts[d]);
+        }
     }
 
     /**
      * Copy constructor.
      */
-    Position(const Position &other)
-        : m_width { other.m_width }
-        , m_height { other.m_height }
-        , m_nbCells { other.m_nbCells }
-        , m_minX { other.m_minX }
-        , m_minY { other.m_minY }
-        , m_maxX { other.m_maxX }
-        , m_maxY { other.m_maxY }
-        , m_nbMoves { other.m_nbMoves }
-        , m_isMyTurn { other.m_isMyTurn }
-
-    {
-        // init int **m_board with 0
-        m_board = new int[m_nbCells];
-        std::copy(other.m_board, other.m_board + m_nbCells, m_board);
-    }
+    Position(const Position &other) = default;
 
     /**
      * Indicates whether a column is playable.
@@ -318,7 +383,8 @@ public:
      */
     inline bool canPlay(int x, int y) const
     {
-        return !m_board[x + y * m_width];
+        int index = cellIndex(x, y);
+        return !m_stones[0].test(index) && !m_stones[1].test(index);
     }
 
     /**
@@ -329,14 +395,9 @@ public:
      */
     inline void play(int x, int y)
     {
-        m_board[x + y * m_width] = m_isMyTurn ? 1 : 2;
+        placeStone(x, y, m_isMyTurn ? 0 : 1);
         m_nbMoves++;
-        m_isMyTurn = !m_isMyTurn;
-
-        m_minX = std::min(m_minX, x);
-        m_minY = std::min(m_minY, y);
-        m_maxX = std::max(m_maxX, x);
-        m_maxY = std::max(m_maxY, y);
+        setIsMyTurn(!m_isMyTurn);
     }
 
     /**
@@ -347,14 +408,9 @@ public:
      */
     inline void play(int x, int y, int isMe)
     {
-        m_board[x + y * m_width] = isMe ? 1 : 2;
+        placeStone(x, y, isMe ? 0 : 1);
         m_nbMoves++;
-        m_isMyTurn = !isMe;
-
-        m_minX = std::min(m_minX, x);
-        m_minY = std::min(m_minY, y);
-        m_maxX = std::max(m_maxX, x);
-        m_maxY = std::max(m_maxY, y);
+        setIsMyTurn(!isMe);
     }
 
     /**
@@ -366,9 +422,49 @@ public:
      */
     inline void clear(int x, int y)
     {
-        m_board[x + y * m_width] = 0;
+        int index = cellIndex(x, y);
+        removeStone(index, m_stones[0].test(index) ? 0 : 1);
+        m_nbMoves--;
+        setIsMyTurn(!m_isMyTurn);
+
+        // the cleared stone may have been on the border of the bounding box
+        computeBoundingBox();
+    }
+
+    /**
+     * Plays a playable move for the current player and saves what is needed to undo it.
+     * Moves must be undone with unmakeMove() in the reverse order.
+     *
+     * @param x: 0-based index of a playable column.
+     * @param y: 0-based index of a playable row.
+     */
+    inline void makeMove(int x, int y)
+    {
+        UndoEntry &entry = m_undoStack[m_undoSize++];
+        entry.index = cellIndex(x, y);
+        entry.minX = m_minX;
+        entry.minY = m_minY;
+        entry.maxX = m_maxX;
+        entry.maxY = m_maxY;
+        entry.isMyTurn = m_isMyTurn;
+
+        play(x, y);
+    }
+
+    /**
+     * Undoes the last move played with makeMove().
+     */
+    inline void unmakeMove()
+    {
+        const UndoEntry &entry = m_undoStack[--m_undoSize];
+
+        removeStone(entry.index, entry.isMyTurn ? 0 : 1);
+        m_minX = entry.minX;
+        m_minY = entry.minY;
+        m_maxX = entry.maxX;
+        m_maxY = entry.maxY;
         m_nbMoves--;
-        m_isMyTurn = !m_isMyTurn;
+        setIsMyTurn(entry.isMyTurn);
     }
 
     /**
@@ -396,105 +492,115 @@ public:
      */
     bool isWinningMove(int x, int y, bool isMyTurn) const
     {
-        // win if 5 in a row / column / diagonal
-        int currentPlayer = isMyTurn ? 1 : 2;
-        int count;
+        // win if 5 in a row / column / diagonal: the runs on both sides of the cell and the cell itself
+        int player = isMyTurn ? 0 : 1;
+        int index = cellIndex(x, y);
 
-        // check horizontal
-        for (int x_ = std::max(0, x - 4); x_ < std::min(m_width - 4, x + 1); x_++) {
-            count = 0;
-            for (int i = 0; i < 5; i++)
-                if (x_ + i == x || m_board[x_ + i + y * m_width] == currentPlayer)
-                    count++;
-
-            if (count == 5)
+        for (int d = 0; d < 4; d++)
+            if (m_runs[player][d][0][index] + m_runs[player][d][1][index] >= 4)
                 return true;
-        }
+        return false;
+    }
 
-        // check vertical
-        for (int y_ = std::max(0, y - 4); y_ < std::min(m_height - 4, y + 1); y_++) {
-            count = 0;
-            for (int i = 0; i < 5; i++)
-                if (y_ + i == y || m_board[x + (y_ + i) * m_width] == currentPlayer)
-                    count++;
+    /**
+     * Empty cells near a stone, the only moves worth searching.
+     */
+    inline const Bitboard &getCandidates() const
+    {
+        return m_candidates;
+    }
 
-            if (count == 5)
-                return true;
+    inline int getNbCandidates() const
+    {
+        return m_nbCandidates;
+    }
+
+    /**
+     * Candidate move of index i < getNbCandidates().
+     * The order of the candidates changes when moves are played and undone.
+     */
+    inline std::pair<int, int> getCandidate(int i) const
+    {
+        return getCell(m_candidateList[i]);
+    }
 
-            for (int x_ = std::max(0, x - 4); x_ < std::min(m_width - 4, x + 1); x_++) {
-                // check diagonal
-                count = 0;
-                for (int i = 0; i < 5; i++)
-                    if (x_ + i == x && y_ + i == y || m_board[x_ + i + (y_ + i) * m_width] == currentPlayer)
-                        count++;
+    /**
+     * Strongest threat made by a player playing an empty cell, over the four line directions.
+     *
+     * @param isMyTurn: true for me, false for the opponent.
+     */
+    inline ThreatType getThreat(int x, int y, bool isMyTurn) const
+    {
+        int player = isMyTurn ? 0 : 1;
+        int index = cellIndex(x, y);
+        return std::max({ m_threats[player][0][index], m_threats[player][1][index], m_threats[player][2][index], m_threats[player][3][index] });
+    }
 
-                if (count == 5)
-                    return true;
+    /**
+     * Empty cells where a player makes a threat of a given type in at least one direction.
+     *
+     * @param isMyTurn: true for me, false for the opponent.
+     */
+    inline const Bitboard &getThreatCells(bool isMyTurn, ThreatType type) const
+    {
+        return m_threatCells[isMyTurn ? 0 : 1][static_cast<int>(type)];
+    }
 
-                // check anti-diagonal
-                count = 0;
-                for (int i = 0; i < 5; i++)
-                    if (x_ + i == x && y_ + 4 - i == y || m_board[x_ + i + (y_ + 4 - i) * m_width] == currentPlayer)
-                        count++;
+    /**
+     * Cell of a bit index of the bitboards.
+     */
+    inline std::pair<int, int> getCell(int index) const
+    {
+        return std::make_pair(index % m_stride, index / m_stride);
+    }
 
-                if (count == 5)
-                    return true;
-            }
-        }
+    /**
+     * Bit index of a cell in the bitboards, inverse of getCell().
+     */
+    inline int getIndex(int x, int y) const
+    {
+        return cellIndex(x, y);
+    }
 
-        return false;
+    /**
+     * Heuristic score of the current position, updated by each move on the windows crossing the played cell.
+     *
+     * @return the heuristic score of the current position.
+     */
+    inline int heuristic() const
+    {
+        return m_score;
     }
 
     /**
-     * Calculates the heuristic score of the current position.
+     * Calculates the heuristic score of the current position from scratch.
+     * It is always equal to heuristic(), which is way cheaper.
      *
      * @return the heuristic score of the current position.
      */
-    int heuristic() const
+    int computeHeuristic() const
     {
         int score = 0;
-
-        int c2 = 0;
-        int c3 = 0;
-        int c4 = 0;
-        int c5 = 0;
-
-        int *board = m_board;
-        for (int y = 0; y < m_height; y++) {
-            for (int x = 0; x < m_width; x++) {
-                if (x < m_height - 4) {
-                    c2 = board[1];
-                    c3 = board[2];
-                    c4 = board[3];
-                    c5 = board[4];
-                    score += heuristicResults[*board + c2 * 3 + c3 * 9 + c4 * 27 + c5 * 81];
+        Bitboard occupied = m_stones[0] | m_stones[1];
+
+        for (int d = 0; d < 4; d++) {
+            int shift = m_shifts[d];
+
+            // empty windows are worth nothing, only visit the ones holding a stone
+            Bitboard starts = occupied;
+            for (int k = 1; k < 5; k++)
+                starts |= occupied >> (k * shift);
+            starts &= m_windowStarts[d];
+
+            starts.forEach([&](int index) {
+                int me = 0;
+                int opponent = 0;
+                for (int k = 0; k < 5; k++) {
+                    me |= m_stones[0].test(index + k * shift) << k;
+                    opponent |= m_stones[1].test(index + k * shift) << k;
                 }
-
-                if (y < m_width - 4) {
-                    c2 = board[m_width];
-                    c3 = board[2 * m_width];
-                    c4 = board[3 * m_width];
-                    c5 = board[4 * m_width];
-                    score += heuristicResults[*board + c2 * 3 + c3 * 9 + c4 * 27 + c5 * 81];
-
-                    if (x < m_height - 4) {
-                        c2 = board[1 + m_width];
-                        c3 = board[2 + 2 * m_width];
-                        c4 = board[3 + 3 * m_width];
-                        c5 = board[4 + 4 * m_width];
-                        score += heuristicResults[*board + c2 * 3 + c3 * 9 + c4 * 27 + c5 * 81];
-                    }
-
-                    if (x > 3) {
-                        c2 = board[-1 + m_width];
-                        c3 = board[-2 + (2) * m_width];
-                        c4 = board[-3 + (3) * m_width];
-                        c5 = board[-4 + (4) * m_width];
-                        score += heuristicResults[*board + c2 * 3 + c3 * 9 + c4 * 27 + c5 * 81];
-                    }
-                }
-                ++board;
-            }
+                score += windowScores.scores[me][opponent];
+            });
         }
 
         return score;
@@ -510,48 +616,22 @@ public:
      */
     inline int getState(int x, int y) const
     {
-        return m_board[x + y * m_width];
+        int index = cellIndex(x, y);
+        return m_stones[0].test(index) ? 1 : m_stones[1].test(index) ? 2 : 0;
     }
 
     /**
      * = operator.
      */
-    Position &operator=(const Position &other)
-    {
-        if (this != &other) {
-            m_width = other.m_width;
-            m_height = other.m_height;
-            m_nbCells = other.m_nbCells;
-            m_minX = other.m_minX;
-            m_maxX = other.m_maxX;
-            m_minY = other.m_minY;
-            m_maxY = other.m_maxY;
-            m_nbMoves = other.m_nbMoves;
-            m_isMyTurn = other.m_isMyTurn;
-            m_hash = other.m_hash;
-
-            delete[] m_board;
-            m_board = new int[m_nbCells];
-            std::copy(other.m_board, other.m_board + m_nbCells, m_board);
-        }
-        return *this;
-    }
+    Position &operator=(const Position &other) = default;
 
     /**
      * == operator.
      */
     bool operator==(const Position &other) const
     {
-        if (m_width != other.m_width || m_height != other.m_height || m_nbCells != other.m_nbCells || m_nbMoves != other.m_nbMoves
-            || m_isMyTurn != other.m_isMyTurn) {
-            return false;
-        }
-        for (int i = 0; i < m_nbCells; i++) {
-            if (m_board[i] != other.m_board[i]) {
-                return false;
-            }
-        }
-        return true;
+        return m_width == other.m_width && m_height == other.m_height && m_nbMoves == other.m_nbMoves && m_isMyTurn == other.m_isMyTurn
+            && m_stones[0] == other.m_stones[0] && m_stones[1] == other.m_stones[1];
     }
 
     /**
@@ -579,13 +659,7 @@ public:
      */
     Position verticalFlip() const
     {
-        Position new_position(*this);
-        for (int y = 0; y < m_height; y++) {
-            for (int x = 0; x < m_width; x++) {
-                new_position.m_board[x + (m_height - y - 1) * m_width] = m_board[x + y * m_width];
-            }
-        }
-        return new_position;
+        return transformed([this](int x, int y) { return std::make_pair(x, m_height - y - 1); });
     }
 
     /**
@@ -605,13 +679,7 @@ public:
      */
     Position horizontalFlip() const
     {
-        Position new_position(*this);
-        for (int y = 0; y < m_height; y++) {
-            for (int x = 0; x < m_width; x++) {
-                new_position.m_board[(m_width - x - 1) + y * m_width] = m_board[x + y * m_width];
-            }
-        }
-        return new_position;
+        return transformed([this](int x, int y) { return std::make_pair(m_width - x - 1, y); });
     }
 
     /**
@@ -631,13 +699,7 @@ public:
      */
     Position diagonalFlip() const
     {
-        Position new_position(*this);
-        for (int y = 0; y < m_height; y++) {
-            for (int x = 0; x < m_width; x++) {
-                new_position.m_board[y + x * m_width] = m_board[x + y * m_width];
-            }
-        }
-        return new_position;
+        return transformed([](int x, int y) { return std::make_pair(y, x); });
     }
 
     /**
@@ -657,82 +719,62 @@ public:
      */
     Position antiDiagonalFlip() const
     {
-        Position new_position(*this);
-        for (int y = 0; y < m_height; y++) {
-            for (int x = 0; x < m_width; x++) {
-                new_position.m_board[(m_height - y - 1) + (m_width - x - 1) * m_width] = m_board[x + y * m_width];
-            }
-        }
-        return new_position;
+        return transformed([this](int x, int y) { return std::make_pair(m_height - y - 1, m_width - x - 1); });
     }
 
     /**
      * Comparison for map key.
      * Two maps symmetric (horizontal, vertical, diagonal, anti-diagonal and rotated) are equal because they are the
-     * same absolute position.
+     * same absolute position: the key is the smallest zobrist hash among the symmetries of the board.
      */
-    uint64_t hash() const
+    inline uint64_t hash() const
     {
-        std::uint32_t hash = simple_hash();
-
-        Position vertical(*this);
-        Position horizontal(*this);
-        Position diagonal(*this);
-        Position antiDiagonal(*this);
-
-        int *board = m_board;
-        for (int y = 0; y < m_height; y++) {
-            for (int x = 0; x < m_width; x++) {
-                vertical.m_board[x + (m_height - y - 1) * m_width] = *board;
-                horizontal.m_board[(m_width - x - 1) + y * m_width] = *board;
-                diagonal.m_board[y + x * m_width] = *board;
-                antiDiagonal.m_board[(m_height - y - 1) + (m_width - x - 1) * m_width] = *board;
-                ++board;
-            }
-        }
-
-        // hash ^= verticalFlip().simple_hash();
-        hash ^= vertical.simple_hash();
-        // hash ^= horizontalFlip().simple_hash();
-        hash ^= horizontal.simple_hash();
+        return m_hashes[getSymmetry()];
+    }
 
-        // hash ^= diagonalFlip().simple_hash();
-        hash ^= diagonal.simple_hash();
-        // hash ^= antiDiagonalFlip().simple_hash();
-        hash ^= antiDiagonal.simple_hash();
+    /**
+     * Symmetry giving the canonical hash of the position, see symmetricCell().
+     */
+    inline int getSymmetry() const
+    {
+        // diagonal flips and quarter turns only map a square board on itself
+        int nbSymmetries = m_width == m_height ? NB_SYMMETRIES : NB_SYMMETRIES / 2;
+        int symmetry = 0;
+
+        for (int i = 1; i < nbSymmetries; i++)
+            if (m_hashes[i] < m_hashes[symmetry])
+                symmetry = i;
+        return symmetry;
+    }
 
-        board = vertical.m_board;
-        for (int y = 0; y < m_height; y++) {
-            for (int x = 0; x < m_width; x++) {
-                horizontal.m_board[(m_width - x - 1) + y * m_width] = *board;
-                diagonal.m_board[y + x * m_width] = *board;
-                antiDiagonal.m_board[(m_height - y - 1) + (m_width - x - 1) * m_width] = *board;
-                ++board;
-            }
-        }
+    /**
+     * Cell of a move in the orientation giving the canonical hash (x + y * MAX_BOARD_SIZE),
+     * so a move stored with hash() can be read back from any symmetric position.
+     */
+    inline int canonicalCell(int x, int y) const
+    {
+        return symmetricCell(getSymmetry(), x, y);
+    }
 
-        // hash ^= verticalFlip().horizontalFlip().simple_hash();
-        hash ^= horizontal.simple_hash();
-        // hash ^= verticalFlip().diagonalFlip().simple_hash();
-        hash ^= diagonal.simple_hash();
-        // hash ^= verticalFlip().antiDiagonalFlip().simple_hash();
-        hash ^= antiDiagonal.simple_hash();
+    /**
+     * Move of this position from a canonical cell, inverse of canonicalCell().
+     */
+    inline std::pair<int, int> fromCanonicalCell(int cell) const
+    {
+        // the quarter turns are the inverse of each other, the other symmetries are their own inverse
+        int symmetry = getSymmetry();
+        int inverse = symmetry == 6 ? 7 : symmetry == 7 ? 6 : symmetry;
+        int original = symmetricCell(inverse, cell % MAX_BOARD_SIZE, cell / MAX_BOARD_SIZE);
 
-        return hash;
+        return std::make_pair(original % MAX_BOARD_SIZE, original / MAX_BOARD_SIZE);
     }
 
-    inline uint64_t simple_hash() const
+    /**
+     * Zobrist hash of the position (stones and player to move), maintained incrementally by each move.
+     */
+    inline uint64_t zobristHash() const
     {
-        uint64_t hash = 0;
-
-        int nbCells = m_nbCells;
-        int *board = m_board;
-        while (nbCells) {
-            hash ^= hash * 0xc0fe + *board;
-            ++board;
-            --nbCells;
-        }
-        return hash;
+        return m_hashes[0];
     }
 
     /**
@@ -747,7 +789,7 @@ public:
             if (y > 0)
                 ss << std::endl;
             for (int x = 0; x < m_width; x++)
-                ss << m_board[x + y * m_width];
+                ss << getState(x, y);
         }
         return ss.str();
     }
@@ -799,20 +841,376 @@ public:
         return m_isMyTurn;
     }
 
+    /**
+     * Passes the turn, for the null move pruning of the search.
+     */
+    inline void makeNullMove()
+    {
+        setIsMyTurn(!m_isMyTurn);
+    }
+
+    inline void unmakeNullMove()
+    {
+        setIsMyTurn(!m_isMyTurn);
+    }
+
     inline void setIsMyTurn(bool isMyTurn)
     {
+        if (isMyTurn != m_isMyTurn)
+            for (int i = 0; i < NB_SYMMETRIES; i++)
+                m_hashes[i] ^= zobristKeys.side;
         m_isMyTurn = isMyTurn;
     }
 
 private:
+    /**
+     * Bit index of a cell in the padded bitboards.
+     */
+    inline int cellIndex(int x, int y) const
+    {
+        return x + y * m_stride;
+    }
+
+    /**
+     * Bit index of a cell in the layout of a line direction, where the cells of each line follow each other:
+     * the rows, the columns, the diagonals (x - y constant) and the anti-diagonals (x + y constant), each cell at
+     * position y in its line but for the rows.
+     */
+    static inline int lineIndex(int direction, int x, int y)
+    {
+        switch (direction) {
+        case 0:
+            return LINE_PADDING + y * LINE_SIZE + x;
+        case 1:
+            return LINE_PADDING + x * LINE_SIZE + y;
+        case 2:
+            return LINE_PADDING + (x - y + MAX_BOARD_SIZE - 1) * LINE_SIZE + y;
+        default:
+            return LINE_PADDING + (x + y) * LINE_SIZE + y;
+        }
+    }
+
+    static inline void toggleLineBit(std::uint64_t *layout, int index)
+    {
+        layout[index >> 6] ^= std::uint64_t(1) << (index & 63);
+    }
+
+    /**
+     * Extracts the line of 2 * radius + 1 cells centered on a cell of a line layout: bit k holds the cell at offset
+     * k - radius along the direction. The cells out of the board read as empty, radius must be at most LINE_PADDING.
+     */
+    static inline int lineAround(const std::uint64_t *layout, int index, int radius = 4)
+    {
+        int start = index - radius;
+        int bit = start & 63;
+        std::uint64_t line = layout[start >> 6] >> bit;
+        if (bit)
+            line |= layout[(start >> 6) + 1] << (64 - bit);
+        return static_cast<int>(line & ((std::uint64_t(1) << (2 * radius + 1)) - 1));
+    }
+
+    /**
+     * Toggles a stone of a player in the line layouts.
+     */
+    inline void toggleLineStone(int x, int y, int player)
+    {
+        for (int d = 0; d < 4; d++)
+            toggleLineBit(m_lineStones[player][d], lineIndex(d, x, y));
+    }
+
+    inline void placeStone(int x, int y, int player)
+    {
+        updateScore(cellIndex(x, y), player);
+        m_stones[player].set(cellIndex(x, y));
+        toggleLineStone(x, y, player);
+        updateHashes(x, y, player);
+        updateCandidates(x, y, 1);
+        joinRuns(cellIndex(x, y), player);
+        updateThreats(cellIndex(x, y));
+
+        m_minX = std::min(m_minX, x);
+        m_minY = std::min(m_minY, y);
+        m_maxX = std::max(m_maxX, x);
+        m_maxY = std::max(m_maxY, y);
+    }
+
+    inline void removeStone(int index, int player)
+    {
+        updateScore(index, player);
+        m_stones[player].reset(index);
+        toggleLineStone(index % m_stride, index / m_stride, player);
+        updateHashes(index % m_stride, index / m_stride, player);
+        updateCandidates(index % m_stride, index / m_stride, -1);
+        splitRuns(index, player);
+        updateThreats(index);
+    }
+
+    /**
+     * Reclassifies the threats of both players on the cells up to 4 cells away from a cell whose stone has just
+     * been toggled, only in the direction of the line joining them.
+     */
+    inline void updateThreats(int index)
+    {
+        int x = index % m_stride;
+        int y = index / m_stride;
+
+        for (int d = 0; d < 4; d++) {
+            int shift = m_shifts[d];
+            int line = lineIndex(d, x, y);
+            // lines of 17 cells, the lines of 9 cells around each updated cell are read from them
+            int stones[2] = { lineAround(m_lineStones[0][d], line, 8), lineAround(m_lineStones[1][d], line, 8) };
+            int offBoard = ~lineAround(m_lineOnBoard[d], line, 8);
+
+            for (int k = -4; k <= 4; k++) {
+                int cell = index + k * shift;
+                if ((offBoard >> (k + 8)) & 1)
+                    continue;
+
+                int start = k + 4;
+                bool empty = !(((stones[0] | stones[1]) >> (start + 4)) & 1);
+                for (int player = 0; player < 2; player++) {
+                    ThreatType type = ThreatType::none;
+                    if (empty)
+                        type = threatPatterns.get((stones[player] >> start) & 511, ((stones[1 - player] | offBoard) >> start) & 511);
+                    setThreat(player, d, cell, type);
+                }
+            }
+        }
+    }
+
+    inline void setThreat(int player, int direction, int index, ThreatType type)
+    {
+        ThreatType previous = m_threats[player][direction][index];
+        if (previous == type)
+            return;
+        m_threats[player][direction][index] = type;
+
+        // the cell keeps the previous type if another direction still has it, the cells without threat are not listed
+        bool kept = false;
+        for (int d = 0; d < 4; d++)
+            kept |= m_threats[player][d][index] == previous;
+        if (!kept && previous != ThreatType::none)
+            m_threatCells[player][static_cast<int>(previous)].reset(index);
+        if (type != ThreatType::none)
+            m_threatCells[player][static_cast<int>(type)].set(index);
+    }
+
+    /**
+     * Updates the runs of a player around a cell where the player has just played: the cells ending the run of the cell
+     * on each side now see the whole run. The runs of the cell itself are kept but not maintained anymore.
+     */
+    inline void joinRuns(int index, int player)
+    {
+        for (int d = 0; d < 4; d++) {
+            int shift = m_shifts[d];
+            int before = m_runs[player][d][0][index];
+            int after = m_runs[player][d][1][index];
+            int length = before + after + 1;
+
+            setRun(player, d, 1, index - (before + 1) * shift, length);
+            setRun(player, d, 0, index + (after + 1) * shift, length);
+        }
+    }
+
+    /**
+     * Updates the runs of a player around a cell where one of its stones has just been removed.
+     * The runs of the cell may be outdated, they are read back from the stones.
+     */
+    inline void splitRuns(int index, int player)
+    {
+        const Bitboard &stones = m_stones[player];
+
+        for (int d = 0; d < 4; d++) {
+            int shift = m_shifts[d];
+            int before = 0;
+            int after = 0;
+            while (stones.test(index - (before + 1) * shift))
+                before++;
+            while (stones.test(index + (after + 1) * shift))
+                after++;
+
+            m_runs[player][d][0][index] = before;
+            m_runs[player][d][1][index] = after;
+            setRun(player, d, 1, index - (before + 1) * shift, before);
+            setRun(player, d, 0, index + (after + 1) * shift, after);
+        }
+    }
+
+    /**
+     * Sets a run length of a cell ending a run, if the cell is in the bitboards.
+     */
+    inline void setRun(int player, int direction, int side, int index, int length)
+    {
+        if (static_cast<unsigned>(index) < BITBOARD_BITS)
+            m_runs[player][direction][side][index] = length;
+    }
+
+    /**
+     * Updates the candidate moves when a stone is added (delta = 1) or removed (delta = -1) on a cell,
+     * it must be called after the stone is toggled.
+     */
+    inline void updateCandidates(int x, int y, int delta)
+    {
+        int minX = std::max(0, x - CANDIDATE_RADIUS);
+        int maxX = std::min(m_width - 1, x + CANDIDATE_RADIUS);
+        int minY = std::max(0, y - CANDIDATE_RADIUS);
+        int maxY = std::min(m_height - 1, y + CANDIDATE_RADIUS);
+
+        for (int j = minY; j <= maxY; j++) {
+            for (int i = minX; i <= maxX; i++) {
+                int index = cellIndex(i, j);
+                m_nbNear[index] += delta;
+
+                bool candidate = m_nbNear[index] > 0 && canPlay(i, j);
+                if (candidate && !m_candidates.test(index))
+                    addCandidate(index);
+                else if (!candidate && m_candidates.test(index))
+                    removeCandidate(index);
+            }
+        }
+    }
+
+    inline void addCandidate(int index)
+    {
+        m_candidates.set(index);
+        m_candidateSlots[index] = m_nbCandidates;
+        m_candidateList[m_nbCandidates++] = index;
+    }
+
+    /**
+     * Removes a candidate in constant time, the last candidate of the list takes its slot.
+     */
+    inline void removeCandidate(int index)
+    {
+        int slot = m_candidateSlots[index];
+        int last = m_candidateList[--m_nbCandidates];
+
+        m_candidates.reset(index);
+        m_candidateList[slot] = last;
+        m_candidateSlots[last] = slot;
+    }
+
+    /**
+     * Updates the heuristic score when a stone of a player is added or removed on a cell.
+     * Only the (at most 20) windows crossing the cell change, it must be called before the stone is toggled.
+     */
+    inline void updateScore(int index, int player)
+    {
+        int x = index % m_stride;
+        int y = index / m_stride;
+
+        for (int d = 0; d < 4; d++) {
+            int line = lineIndex(d, x, y);
+            int onBoard = lineAround(m_lineOnBoard[d], line);
+            int before[2] = { lineAround(m_lineStones[0][d], line), lineAround(m_lineStones[1][d], line) };
+            int after[2] = { before[0], before[1] };
+            after[player] ^= 1 << 4;
+
+            // window w covers the bits w to w + 4 of the lines
+            for (int w = 0; w < 5; w++) {
+                if (((onBoard >> w) & 31) != 31)
+                    continue;
+                m_score += windowScores.scores[(after[0] >> w) & 31][(after[1] >> w) & 31];
+                m_score -= windowScores.scores[(before[0] >> w) & 31][(before[1] >> w) & 31];
+            }
+        }
+    }
+
+    /**
+     * Zobrist key index of the image of a cell by a board symmetry:
+     * 0 = identity, 1 = vertical flip, 2 = horizontal flip, 3 = half turn,
+     * 4 = diagonal flip, 5 = anti-diagonal flip, 6 and 7 = quarter turns.
+     */
+    inline int symmetricCell(int symmetry, int x, int y) const
+    {
+        int w = m_width - 1;
+        int h = m_height - 1;
+
+        switch (symmetry) {
+        case 0:
+            return x + y * MAX_BOARD_SIZE;
+        case 1:
+            return x + (h - y) * MAX_BOARD_SIZE;
+        case 2:
+            return (w - x) + y * MAX_BOARD_SIZE;
+        case 3:
+            return (w - x) + (h - y) * MAX_BOARD_SIZE;
+        case 4:
+            return y + x * MAX_BOARD_SIZE;
+        case 5:
+            return (h - y) + (w - x) * MAX_BOARD_SIZE;
+        case 6:
+            return (h - y) + x * MAX_BOARD_SIZE;
+        default:
+            return y + (w - x) * MAX_BOARD_SIZE;
+        }
+    }
+
+    /**
+     * Toggles a stone in the hash of each symmetry of the board.
+     */
+    inline void updateHashes(int x, int y, int player)
+    {
+        for (int i = 0; i < NB_SYMMETRIES; i++)
+            m_hashes[i] ^= zobristKeys.stones[player][symmetricCell(i, x, y)];
+    }
+
+    /**
+     * Recomputes the bounding box from scratch, used when a stone is removed out of the undo stack.
+     */
+    void computeBoundingBox()
+    {
+        m_minX = m_width - 1;
+        m_minY = m_height - 1;
+        m_maxX = 0;
+        m_maxY = 0;
+        (m_stones[0] | m_stones[1]).forEach([this](int index) {
+            m_minX = std::min(m_minX, index % m_stride);
+            m_minY = std::min(m_minY, index / m_stride);
+            m_maxX = std::max(m_maxX, index % m_stride);
+            m_maxY = std::max(m_maxY, index / m_stride);
+        });
+    }
+
+    /**
+     * Builds the position obtained by moving each stone of (x, y) to transform(x, y).
+     */
+    template <typename Transform>
+    Position transformed(Transform transform) const
+    {
+        Position new_position(m_width, m_height);
+        for (int player = 0; player < 2; player++) {
+            m_stones[player].forEach([&](int index) {
+                std::pair<int, int> cell = transform(index % m_stride, index / m_stride);
+                new_position.placeStone(cell.first, cell.second, player);
+            });
+        }
+        new_position.m_nbMoves = m_nbMoves;
+        new_position.setIsMyTurn(m_isMyTurn);
+        return new_position;
+    }
+
     // width of the board
     int m_width;
     // height of the board
     int m_height;
     // total number of cells
     int m_nbCells;
-    // board (0 = empty, 1 = me, 2 = opponent)
-    int *m_board;
+    // distance between two rows in the bitboards (width + sentinel column)
+    int m_stride;
+    // bit offset of the next cell for each line direction (horizontal, vertical, diagonal, anti-diagonal)
+    int m_shifts[4];
+
+    // stones of each player (0 = me, 1 = opponent)
+    Bitboard m_stones[2];
+    // cells inside the board
+    Bitboard m_onBoard;
+    // cells starting a five cells window inside the board, for each line direction
+    Bitboard m_windowStarts[4];
+    // the stones of each player and the cells inside the board again, in the layout of each line direction (see lineIndex()),
+    // so the cells around a cell along a direction are read with a single shift
+    std::uint64_t m_lineStones[2][4][LINE_WORDS];
+    std::uint64_t m_lineOnBoard[4][LINE_WORDS];
 
     // min x of the board
     int m_minX;
@@ -828,9 +1226,37 @@ private:
     // current player (true = me, false = opponent)
     bool m_isMyTurn;
 
-    // hash optimization
-    uint64_t m_hash;
+    // moves played with makeMove(), undone in the reverse order by unmakeMove()
+    UndoEntry m_undoStack[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+    // number of moves in the undo stack
+    int m_undoSize;
+
+    // zobrist hash of each symmetry of the board (see symmetricCell()), xored with the side key when the opponent is to move
+    uint64_t m_hashes[NB_SYMMETRIES];
+
+    // heuristic score of the position
+    int m_score;
+
+    // number of stones at most CANDIDATE_RADIUS cells away from each cell, the cell included
+    std::uint8_t m_nbNear[BITBOARD_BITS];
+    // empty cells near a stone
+    Bitboard m_candidates;
+    // bit indexes of the candidates, in no particular order
+    std::int16_t m_candidateList[BITBOARD_BITS];
+    // index of each candidate in m_candidateList, meaningless for the other cells
+    std::int16_t m_candidateSlots[BITBOARD_BITS];
+    // number of candidates
+    int m_nbCandidates;
+
+    // number of consecutive stones of each player just before (side 0) and just after (side 1) each cell,
+    // for each line direction, exact for the cells which are not a stone of the player
+    std::uint8_t m_runs[2][4][2][BITBOARD_BITS];
+
+    // threat made by each player playing each empty cell, for each line direction, none on the stones
+    ThreatType m_threats[2][4][BITBOARD_BITS];
+    // empty cells where each player makes a threat of each type in at least one direction, empty for ThreatType::none
+    Bitboard m_threatCells[2][NB_THREAT_TYPES];
 };
 }
 
-#endif /* PPAY_POSITION_HPP */
\ No newline at end of file
+#endif /* PPAY_POSITION_HPP */
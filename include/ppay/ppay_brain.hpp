@@ -36,11 +36,23 @@ public:
     bool brainBlock(std::uint32_t x, std::uint32_t y) override;
     void brainTakeback(std::uint32_t x, std::uint32_t y) override;
     void brainEnd() override;
+    bool brainPonderStart() override;
+    void brainPonder() override;
+    void brainPonderStop() override;
 
 protected:
     Position *m_currentPos;
 
     Solver *m_solver;
+
+    // position searched on the opponent time: after the expected reply if there is one, else before any reply
+    Position *m_ponderPos;
+    // expected reply of the opponent, (-1, -1) if none
+    Move m_ponderMove;
+    // best move of the last ponder search
+    Move m_ponderResult;
+    // the opponent played the expected reply, the ponder search gives our move
+    bool m_ponderHit;
 };
 }
 
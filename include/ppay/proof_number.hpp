@@ -0,0 +1,128 @@
+/**
+ * @file proof_number.hpp
+ * @brief Depth-first proof-number search (df-pn)
+ */
+
+#ifndef PPAY_PROOF_NUMBER_HPP
+#define PPAY_PROOF_NUMBER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "position.hpp"
+#include "time_manager.hpp"
+
+namespace gmk::ppay {
+
+// proof or disproof number of a position which cannot be proven
+#define PN_INFINITY 100000000u
+// memory of the table of proof and disproof numbers when the manager gives no limit, in bytes
+#define PN_DEFAULT_MEMORY (8 * 1024 * 1024)
+
+enum class PNResult {
+    unknown,
+    // the player to move wins
+    win,
+    // the opponent of the player to move wins
+    loss,
+};
+
+struct PNEntry {
+    // zobrist hash of the position, 0 for an empty entry
+    std::uint64_t key;
+    // number of positions to prove to prove the position is won by the attacker
+    std::uint32_t pn;
+    // number of positions to prove to prove the position is not won by the attacker
+    std::uint32_t dn;
+};
+
+/**
+ * Proves a position won or lost: the attacker only needs one winning move, the defender needs all its moves to lose.
+ * The attacker only plays threats, so a position is proven when it is won by a sequence of fours and threes,
+ * and disproven as soon as the attacker runs out of threats.
+ * The proof and disproof numbers are kept in a table shared by the transpositions, so the search only keeps the
+ * current path in memory.
+ */
+class PNSolver {
+public:
+    /**
+     * @param memory: memory of the table in bytes.
+     */
+    PNSolver(std::size_t memory = PN_DEFAULT_MEMORY);
+
+    /**
+     * Tries to prove a win of the player to move, then a win of the opponent, each on half of the budget.
+     *
+     * @param pos: position searched, restored before returning.
+     * @param maxNodes: maximum number of positions visited.
+     * @param maxTime: time given to the search in milliseconds.
+     * @param move: set to the winning move when the result is a win.
+     * @param time: time manager of the turn, the search also stops when the turn has no time left.
+     */
+    PNResult solve(Position &pos, int maxNodes, std::uint32_t maxTime, Move &move, const TimeManager *time = nullptr);
+
+    /**
+     * Reallocates the table for a new memory limit, with the biggest power of two number of entries fitting in it.
+     *
+     * @param memory: memory of the table in bytes.
+     */
+    void resize(std::size_t memory);
+
+    inline int getNodeCount() const
+    {
+        return m_nodeCount;
+    }
+
+private:
+    /**
+     * Proves the position is won by the attacker, or not, within the budget.
+     */
+    bool prove(Position &pos, bool attacker, int maxNodes, std::uint32_t maxTime, const TimeManager *time);
+
+    /**
+     * Searches a position until its proof number reaches thpn or its disproof number reaches thdn.
+     */
+    void mid(Position &pos, std::uint32_t thpn, std::uint32_t thdn);
+
+    /**
+     * Pushes the moves searched in a position on the move stack: the threats of the attacker, and the replies of the
+     * defender to these threats.
+     *
+     * @return false if the position is decided: then pn and dn are set, and no move is pushed.
+     */
+    bool generateMoves(const Position &pos, std::uint32_t &pn, std::uint32_t &dn);
+
+    /**
+     * Proof and disproof numbers of a position, 1 if it has never been searched.
+     */
+    inline void lookup(std::uint64_t key, std::uint32_t &pn, std::uint32_t &dn) const
+    {
+        const PNEntry &entry = m_table[key & m_mask];
+        pn = entry.key == key ? entry.pn : 1;
+        dn = entry.key == key ? entry.dn : 1;
+    }
+
+    inline void store(std::uint64_t key, std::uint32_t pn, std::uint32_t dn)
+    {
+        m_table[key & m_mask] = { key, pn, dn };
+    }
+
+    // always replaced on collision
+    std::unique_ptr<PNEntry[]> m_table;
+    std::size_t m_mask;
+
+    // player trying to prove a win (true = me)
+    bool m_attacker;
+    int m_nodeCount;
+    // node count stopping the current proof
+    int m_maxNodes;
+    // the budget is exhausted
+    bool m_stop;
+    // moves of the nodes of the current path, the moves of a node follow the moves of its parent
+    std::vector<Move> m_moves;
+    Deadline m_deadline;
+};
+}
+
+#endif /* PPAY_PROOF_NUMBER_HPP */
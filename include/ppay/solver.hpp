@@ -6,90 +6,371 @@
 #ifndef PPAY_SOLVER_HPP
 #define PPAY_SOLVER_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <string>
 #include <vector>
-#ifdef __linux__
-#include <chrono>
-#elif _WIN32
-#include <ctime>
-#else
-#error "Unsupported platform"
-#endif
 
 #include "core/brain_core.hpp"
 
+#include "move_picker.hpp"
 #include "position.hpp"
+#include "proof_number.hpp"
+#include "time_manager.hpp"
 #include "transposition_table.hpp"
+#include "vcf.hpp"
+#include "vct.hpp"
 
 namespace gmk::ppay {
 
-// Retrun a response just few ms before the time is up
-#define TIMEOUT_TURN_LIMIT 10
+// part of the manager memory limit given to the transposition table (1 / TT_MEMORY_DIVISOR)
+#define TT_MEMORY_DIVISOR 2
+// memory of the transposition table when the manager gives no limit, in bytes
+#define TT_DEFAULT_MEMORY (64 * 1024 * 1024)
+// part of the manager memory limit given to the table of the proof-number search (1 / PN_MEMORY_DIVISOR)
+#define PN_MEMORY_DIVISOR 8
 
-using Move = std::pair<int, int>;
+// score of a won position for the player to move, a lost position scores -SCORE_WIN
+#define SCORE_WIN (INT_MAX - 1)
+// bound of the search windows, above any score
+#define SCORE_INFINITY INT_MAX
+
+// half width of the first window of an iteration around the score of the last iteration of the same parity, doubled on each failure
+#define ASPIRATION_WINDOW 200
+// depth of the previous iteration from which the windows are narrowed
+#define ASPIRATION_MIN_DEPTH 4
+
+// late move reductions: remaining depth from which the quiet moves are reduced
+#define LMR_MIN_DEPTH 3
+// number of moves searched in a node before the next quiet moves are reduced by one ply
+#define LMR_MIN_MOVES 3
+// number of moves searched in a node before the next quiet moves are reduced by two plies
+#define LMR_LATE_MOVES 8
+
+// null move pruning: remaining depth from which passing the turn is tried
+#define NULL_MOVE_MIN_DEPTH 3
+// depth reduction of the search after a null move, in addition to the passed ply
+#define NULL_MOVE_REDUCTION 2
+
+// maximum number of plies of the quiescence search at the leaves, fours and their blocks
+#define QS_MAX_DEPTH 6
+
+// probcut: remaining depth from which a shallow search may cut a node
+#define PROBCUT_MIN_DEPTH 5
+// depth reduction of the shallow search, even so both searches end with the same player
+#define PROBCUT_REDUCTION 4
+// linear fit deep = shallow * PROBCUT_SLOPE / 100 + PROBCUT_OFFSET of the score pairs logged by setProbCutLog(), and its standard deviation
+#define PROBCUT_SLOPE 100
+#define PROBCUT_OFFSET 50
+#define PROBCUT_SIGMA 250
+// number of standard deviations (in percents) the predicted deep score must be above beta to cut
+#define PROBCUT_CONFIDENCE 150
+
+// maximum depth of the iterative deepening
+#define MAX_DEPTH 64
+// maximum number of search threads
+#define MAX_THREADS 64
+
+// maximum number of positions of a proof attempt in a tactical position
+#define PN_MAX_NODES 200000
+// part of the remaining time of the turn given to a proof attempt (1 / PN_TIME_DIVISOR)
+#define PN_TIME_DIVISOR 4
+
+enum class SolverMode {
+    // heuristic search, after a proof attempt in the tactical positions only
+    search,
+    // proof attempt on half of each turn, then heuristic search if the position is not won
+    proof,
+};
+
+struct RootMove {
+    Move move;
+    // score of the last iteration
+    int score;
+};
+
+/**
+ * State of one thread of the search: all threads search the same root on their own position (lazy SMP),
+ * and share their results through the transposition table.
+ */
+struct SearchThread {
+    SearchThread(int id, const Position &pos, const std::vector<RootMove> &rootMoves)
+        : id(id)
+        , pos(pos)
+        , rootMoves(rootMoves)
+        , nodeCount(0)
+        , completedDepth(0)
+        , bestMove(rootMoves.front().move)
+        , history {}
+        , quiets((MAX_DEPTH + 1) * pos.getNbCells())
+    {
+        for (auto &plyKillers : killers)
+            for (auto &killer : plyKillers)
+                killer = Move(-1, -1);
+    }
+
+    // 0 for the main thread, which checks the time
+    int id;
+    Position pos;
+    std::vector<RootMove> rootMoves;
+    int nodeCount;
+    // depth of the last complete iteration, 0 if none
+    int completedDepth;
+    // best move of the last complete iteration
+    Move bestMove;
+    // last moves which made a cutoff at each ply, the most recent first
+    Move killers[MAX_DEPTH + 1][NB_KILLERS];
+    // cutoffs made by each move of each player (0 = me, 1 = opponent) on a cell (x + y * MAX_BOARD_SIZE), weighted by depth
+    int history[2][MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+    // quiet moves scored by the move picker of each ply, as many as the cells of the board, off the stack of the search
+    std::vector<QuietMove> quiets;
+};
 
 class Solver {
 public:
-    Solver(int width, int height, uint32_t max_memory, uint32_t maxTime);
+    Solver(int width, int height, uint32_t max_memory, uint32_t maxTime, uint32_t threads = 1);
     ~Solver();
 
-    void generateMovesOrder(const Position &pos);
-
-    int minimax(const Position &pos, int deep, int alpha, int beta, bool maximizingPlayer);
+    /**
+     * Principal variation search of the position of a thread.
+     *
+     * @param allowNullMove: false right after a null move, the turn is not passed twice in a row.
+     * @return the score of the position for the player to move, or a bound of it outside of ]alpha, beta[.
+     */
+    int negamax(SearchThread &thread, int deep, int ply, int alpha, int beta, bool allowNullMove);
+    /**
+     * Search of the leaves of negamax() playing only the fours and their blocks, until no four is left.
+     *
+     * @param qdepth: maximum number of plies left.
+     * @return the score of the position for the player to move, or a bound of it outside of ]alpha, beta[.
+     */
+    int quiescence(SearchThread &thread, int qdepth, int alpha, int beta);
+    /**
+     * Searches the root moves of a thread with a window, and sorts them from the best.
+     *
+     * @return the best score, or a bound of it outside of ]alpha, beta[.
+     */
+    int searchRoot(SearchThread &thread, int depth, int alpha, int beta);
+    void iterativeDeepening(SearchThread &thread);
     Move findBestMove(const Position &pos);
 
-    inline bool isTooFar(const Position &pos, int x, int y)
+    /**
+     * Time left for the search of the turn, in milliseconds: none when aborted, a full turn for a ponder search until
+     * the opponent moves.
+     */
+    inline uint32_t getRemainingTime() const
     {
-        return x < pos.getMinX() - m_awayLimit || x > pos.getMaxX() + m_awayLimit || y < pos.getMinY() - m_awayLimit || y > pos.getMaxY() + m_awayLimit;
+        return m_time.getRemainingTime();
     }
 
-    inline uint32_t getRemainingTime() const
+    inline void setMaxTime(uint32_t maxTime)
     {
-#ifdef __linux__
-        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-        std::chrono::duration<double, std::milli> elapsed = end - m_startTurn;
+        m_time.setTurnTime(maxTime);
+    }
 
-        if (elapsed.count() > m_maxTime - TIMEOUT_TURN_LIMIT) {
-            return 0;
-        }
-        return m_maxTime - TIMEOUT_TURN_LIMIT - elapsed.count();
-#elif _WIN32
-        std::clock_t end = std::clock();
-        uint32_t elapsed = (uint32_t)((end - m_startTurn) / (CLOCKS_PER_SEC / 1000));
+    inline void setMatchTime(uint32_t matchTime)
+    {
+        m_time.setMatchTime(matchTime);
+    }
+
+    inline void setTimeLeft(uint32_t timeLeft)
+    {
+        m_time.setTimeLeft(timeLeft);
+    }
+
+    /**
+     * Makes the next search a ponder search of a position on the opponent time: it goes on until ponderHit() or abort().
+     * The turn starts now, before the search, so the opponent move can come at any time.
+     */
+    inline void startPonder(const Position &pos)
+    {
+        m_time.startPonder(pos.getNbMoves());
+    }
+
+    /**
+     * The opponent played the move pondered: the running search goes on as a normal one, with a full turn from now.
+     */
+    inline void ponderHit()
+    {
+        m_time.ponderHit();
+    }
+
+    /**
+     * Stops the running search as if the time was up, the threat and proof searches included, until the next
+     * startPonder() or stopPonder().
+     */
+    inline void abort()
+    {
+        m_time.abort();
+    }
+
+    /**
+     * Back to normal searches on our own time, no search must be running.
+     */
+    inline void stopPonder()
+    {
+        m_time.stopPonder();
+    }
 
-        if (elapsed > m_maxTime - TIMEOUT_TURN_LIMIT) {
-            return 0;
+    /**
+     * Expected reply of the player to move: the best move stored in the transposition table, (-1, -1) if none.
+     */
+    inline Move getPonderMove(const Position &pos) const
+    {
+        TTEntry entry;
+        if (m_tt.probe(pos.hash(), entry) && entry.move >= 0) {
+            Move move = pos.fromCanonicalCell(entry.move);
+            if (pos.canPlay(move.first, move.second))
+                return move;
         }
-        return m_maxTime - TIMEOUT_TURN_LIMIT - elapsed;
-#endif
+        return Move(-1, -1);
     }
 
-    inline void setMaxTime(uint32_t maxTime)
+    /**
+     * Sets the manager memory limit (0 = no limit), the tables are reallocated for it, so no search must be running on our
+     * own time. During a ponder search, the tables are only reallocated by the next findBestMove().
+     */
+    inline void setMaxMemory(uint32_t maxMemory)
+    {
+        m_maxMemory = maxMemory;
+        if (m_time.isPondering())
+            m_resizePending.store(true, std::memory_order_release);
+        else
+            resizeTables();
+    }
+
+    inline void setMode(SolverMode mode)
+    {
+        m_mode = mode;
+    }
+
+    /**
+     * Result of the last proof attempt of findBestMove(), unknown if there was none.
+     */
+    inline PNResult getProofResult() const
+    {
+        return m_proofResult;
+    }
+
+    /**
+     * Enables the late move reductions, reducing the depth of the quiet moves searched late in a node.
+     */
+    inline void setLMR(bool useLMR)
+    {
+        m_useLMR = useLMR;
+    }
+
+    /**
+     * Enables the null move pruning, cutting the nodes where passing the turn already fails high.
+     */
+    inline void setNullMove(bool useNullMove)
+    {
+        m_useNullMove = useNullMove;
+    }
+
+    /**
+     * Enables the probcut, cutting the nodes where a shallow search predicts a fail high.
+     */
+    inline void setProbCut(bool useProbCut)
+    {
+        m_useProbCut = useProbCut;
+    }
+
+    /**
+     * Score of the shallow search of probcut above which the deep search fails high on beta with confidence,
+     * at least SCORE_WIN if there is none.
+     */
+    static inline int probCutBound(int beta)
     {
-        m_maxTime = std::max(100u, maxTime);
+        long long margin = static_cast<long long>(PROBCUT_CONFIDENCE) * PROBCUT_SIGMA / 100;
+        long long bound = (static_cast<long long>(beta) - PROBCUT_OFFSET + margin) * 100 / PROBCUT_SLOPE;
+        return static_cast<int>(std::clamp(bound, static_cast<long long>(-SCORE_WIN), static_cast<long long>(SCORE_WIN)));
+    }
+
+    /**
+     * Fitting mode of the parameters of probcut: each principal variation node of the main thread deep enough for probcut
+     * is also searched at the depth of its shallow search, and the line "depth shallow_score deep_score" is appended to
+     * the file when both scores are exact. The extra searches change the tree, the mode is off for an empty path.
+     * No search must be running.
+     */
+    inline void setProbCutLog(const std::string &path)
+    {
+        if (m_probCutLog.is_open())
+            m_probCutLog.close();
+        if (!path.empty())
+            m_probCutLog.open(path, std::ios::app);
+    }
+
+    inline void setThreads(uint32_t threads)
+    {
+        m_nbThreads = std::clamp(threads, 1u, static_cast<uint32_t>(MAX_THREADS));
+    }
+
+    /**
+     * Distance of a move to the center of the board (Chebyshev distance, doubled to stay an integer).
+     */
+    inline int centerDistance(const Move &move) const
+    {
+        return std::max(std::abs(2 * move.first - (m_width - 1)), std::abs(2 * move.second - (m_height - 1)));
+    }
+
+    /**
+     * Memory given to the transposition table for a manager memory limit (0 = no limit), in bytes.
+     */
+    static inline std::size_t getTTMemory(uint32_t maxMemory)
+    {
+        return maxMemory ? maxMemory / TT_MEMORY_DIVISOR : TT_DEFAULT_MEMORY;
+    }
+
+    /**
+     * Memory given to the table of the proof-number search for a manager memory limit (0 = no limit), in bytes.
+     */
+    static inline std::size_t getPNMemory(uint32_t maxMemory)
+    {
+        return maxMemory ? maxMemory / PN_MEMORY_DIVISOR : PN_DEFAULT_MEMORY;
     }
 
 private:
-    std::vector<Move> m_moveOrder;
-    TranspositionTable<std::uint32_t, int> m_tt;
+    inline void resizeTables()
+    {
+        m_tt.resize(getTTMemory(m_maxMemory));
+        m_pn.resize(getPNMemory(m_maxMemory));
+    }
+
+    TranspositionTable m_tt;
+    // searches the victories by fours before the main search
+    VCFSolver m_vcf;
+    // searches the victories by threats before the main search
+    VCTSolver m_vct;
+    // proves the positions won or lost
+    PNSolver m_pn;
+    SolverMode m_mode;
+    PNResult m_proofResult;
+    bool m_useLMR;
+    bool m_useNullMove;
+    bool m_useProbCut;
 
     int m_width;
     int m_height;
 
     uint32_t m_maxMemory;
+    // the memory limit changed during a ponder search, the tables are reallocated before the next search
+    std::atomic<bool> m_resizePending;
 
-    // in milliseconds
-    uint32_t m_maxTime;
-
-#ifdef __linux__
-    std::chrono::steady_clock::time_point m_startTurn;
-#elif _WIN32
-    std::clock_t m_startTurn;
-#endif
+    // budgets of the turn, from the limits changed by the commands during a ponder search, and the state of pondering
+    TimeManager m_time;
 
     int m_depthLimit;
-    int m_awayLimit;
 
-    int m_nodeCount;
+    uint32_t m_nbThreads;
+    // set when the time is up, the running iteration of each thread is then dropped
+    std::atomic<bool> m_stop;
+
+    // (depth, shallow score, deep score) of the principal variation nodes of the main thread, closed out of the fitting mode
+    std::ofstream m_probCutLog;
 };
 }
 
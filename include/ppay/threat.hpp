@@ -0,0 +1,119 @@
+/**
+ * @file threat.hpp
+ * @brief Threats made by playing a cell, classified from the line around the cell
+ */
+
+#ifndef PPAY_THREAT_HPP
+#define PPAY_THREAT_HPP
+
+#include <cstdint>
+
+#include "bitboard.hpp"
+
+namespace gmk::ppay {
+
+// threats made by a move on a line, from the weakest to the strongest
+enum class ThreatType : std::uint8_t {
+    none,
+    // one move makes an open four (split three like .X.XX., or a three with room on one side only)
+    brokenThree,
+    // at least two moves make an open four (.XXX. with room on both sides)
+    openThree,
+    // one move makes a five
+    four,
+    // at least two moves make a five, it cannot be blocked
+    openFour,
+    // five in a row
+    five,
+};
+
+#define NB_THREAT_TYPES 6
+
+/**
+ * Threat made by playing the center of a 9 cells line (offsets -4 to 4), indexed by the 8 other cells:
+ * stones of the player (bits 0-7) and cells blocked by an opponent stone or the border of the board (bits 8-15).
+ * Built once for all the lines.
+ */
+struct ThreatPatterns {
+    ThreatType types[1 << 16];
+
+    ThreatPatterns()
+        : types {}
+    {
+        for (int stones = 0; stones < 256; stones++) {
+            for (int blocked = 0; blocked < 256; blocked++) {
+                if (stones & blocked)
+                    continue;
+                types[stones | blocked << 8] = classify(expand(stones) | 1 << 4, expand(blocked));
+            }
+        }
+    }
+
+    /**
+     * Threat of a line, bit k of each mask is the cell at offset k - 4, the center is ignored.
+     */
+    inline ThreatType get(int stones, int blocked) const
+    {
+        return types[pack(stones) | pack(blocked) << 8];
+    }
+
+private:
+    // 9 cells line to 8 cells index, without the center
+    static inline int pack(int line)
+    {
+        return (line & 15) | ((line >> 5) & 15) << 4;
+    }
+
+    static inline int expand(int cells)
+    {
+        return (cells & 15) | (cells & 0xf0) << 1;
+    }
+
+    /**
+     * Empty cells making a five with the center when played.
+     */
+    static int winningCells(int stones, int blocked)
+    {
+        int cells = 0;
+
+        // the windows w to w + 4 all contain the center
+        for (int w = 0; w < 5; w++) {
+            int window = 31 << w;
+            int missing = window & ~stones;
+            if (!(window & blocked) && bitCount(missing) == 1)
+                cells |= missing;
+        }
+        return cells;
+    }
+
+    /**
+     * Threat of a line where the center has been played.
+     */
+    static ThreatType classify(int stones, int blocked)
+    {
+        for (int w = 0; w < 5; w++)
+            if (((stones >> w) & 31) == 31)
+                return ThreatType::five;
+
+        int nbWinningCells = bitCount(winningCells(stones, blocked));
+        if (nbWinningCells >= 2)
+            return ThreatType::openFour;
+        if (nbWinningCells == 1)
+            return ThreatType::four;
+
+        // count the moves turning the line into an open four
+        int nbOpenFours = 0;
+        for (int k = 0; k < 9; k++) {
+            if (((stones | blocked) >> k) & 1)
+                continue;
+            if (bitCount(winningCells(stones | 1 << k, blocked)) >= 2)
+                nbOpenFours++;
+        }
+        return nbOpenFours >= 2 ? ThreatType::openThree : nbOpenFours == 1 ? ThreatType::brokenThree : ThreatType::none;
+    }
+};
+
+inline const ThreatPatterns threatPatterns;
+}
+
+#endif /* PPAY_THREAT_HPP */
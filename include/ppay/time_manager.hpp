@@ -0,0 +1,263 @@
+/**
+ * @file time_manager.hpp
+ * @brief Time given to each move, from the turn and match limits of the manager
+ */
+
+#ifndef PPAY_TIME_MANAGER_HPP
+#define PPAY_TIME_MANAGER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#ifdef __linux__
+#include <chrono>
+#elif _WIN32
+#include <ctime>
+#else
+#error "Unsupported platform"
+#endif
+
+namespace gmk::ppay {
+
+// Retrun a response just few ms before the time is up
+#define TIMEOUT_TURN_LIMIT 10
+// time of a turn when the manager asks to play as fast as possible (timeout_turn 0), in milliseconds
+#define MIN_TURN_TIME 100
+// time of the match left kept aside, so a move is always answered in time, in milliseconds
+#define MATCH_TIME_RESERVE 200
+
+// number of moves of a game, stones of both players, used to guess the number of moves left
+#define EXPECTED_GAME_MOVES 100
+// our moves left are never guessed below this number
+#define MIN_MOVES_LEFT 10
+// part of the match time left a single move may use at most (1 / MAX_MATCH_TIME_DIVISOR)
+#define MAX_MATCH_TIME_DIVISOR 5
+// the hard budget of a move is at most HARD_TIME_RATIO times its soft budget
+#define HARD_TIME_RATIO 4
+
+// the next iteration is not started after this part of the soft budget, it would likely not end within it
+#define ITERATION_TIME_PERCENT 50
+// soft budget added for each recent change of the best move, in percents
+#define INSTABILITY_TIME_PERCENT 50
+// drop of the score from the last iteration of the same parity making a position critical
+#define CRITICAL_SCORE_DROP 200
+// soft budget of a critical position, in percents
+#define CRITICAL_TIME_PERCENT 150
+// soft budget of a position with few sensible moves, like against a three, in percents
+#define FORCED_TIME_PERCENT 50
+
+/**
+ * Gives each move a soft budget, after which no new iteration is started, and a hard budget, after which the search is stopped.
+ *
+ * With a turn limit only, both are the turn time. With a match limit, the soft budget shares the match time left between
+ * the moves expected to be left, and grows when the search is unstable or the position critical. The hard budget never
+ * exceeds the turn time nor a part of the match time left, so no move is ever played late.
+ */
+class TimeManager {
+public:
+    TimeManager(std::uint32_t turnTime);
+
+    /**
+     * Time limit of a turn, 0 to play as fast as possible.
+     */
+    inline void setTurnTime(std::uint32_t turnTime)
+    {
+        m_turnTime = turnTime;
+    }
+
+    /**
+     * Time limit of the whole match, 0 if there is none.
+     */
+    inline void setMatchTime(std::uint32_t matchTime)
+    {
+        m_matchTime = matchTime;
+    }
+
+    /**
+     * Time of the match left before the turn, as given by the manager.
+     */
+    inline void setTimeLeft(std::uint32_t timeLeft)
+    {
+        m_timeLeft = timeLeft;
+    }
+
+    /**
+     * Computes the budgets of a move and starts the clock.
+     *
+     * @param nbMoves: number of stones on the board.
+     */
+    void startTurn(int nbMoves);
+
+    /**
+     * Computes the budgets again from the current limits and restarts the clock, for a turn started before the opponent moved.
+     */
+    void restartTurn();
+
+    /**
+     * Starts a turn on the opponent time: its time does not run until ponderHit(), and it is over at abort().
+     *
+     * @param nbMoves: number of stones on the board searched.
+     */
+    inline void startPonder(int nbMoves)
+    {
+        startTurn(nbMoves);
+        m_aborted = false;
+        m_pondering = true;
+    }
+
+    /**
+     * The opponent played the move pondered: the turn goes on with its budgets computed again from now.
+     */
+    inline void ponderHit()
+    {
+        restartTurn();
+        m_pondering.store(false, std::memory_order_release);
+    }
+
+    /**
+     * The turn has no time left, until the next startPonder() or stopPonder().
+     */
+    inline void abort()
+    {
+        m_aborted = true;
+    }
+
+    /**
+     * Back to turns on our own time.
+     */
+    inline void stopPonder()
+    {
+        m_aborted = false;
+        m_pondering = false;
+    }
+
+    inline bool isPondering() const
+    {
+        return m_pondering.load(std::memory_order_acquire);
+    }
+
+    /**
+     * The move has few sensible answers, it is given less time.
+     */
+    void setForced();
+
+    /**
+     * Indicates whether the search should stop after a complete iteration.
+     *
+     * @param depth: depth of the iteration.
+     * @param bestMoveChanged: the iteration changed the best move.
+     * @param score: score of the iteration.
+     */
+    bool shouldStop(int depth, bool bestMoveChanged, int score);
+
+    /**
+     * Budget of a turn with no match limit, in milliseconds: a few ms before the turn limit, at least 1.
+     */
+    inline std::uint32_t getTurnTime() const
+    {
+        std::uint32_t turnTime = m_turnTime.load();
+        if (turnTime == 0)
+            return MIN_TURN_TIME - TIMEOUT_TURN_LIMIT;
+        return turnTime > TIMEOUT_TURN_LIMIT ? turnTime - TIMEOUT_TURN_LIMIT : 1;
+    }
+
+    /**
+     * Time left before the hard budget is spent, in milliseconds: none after abort(), a full turn when pondering.
+     */
+    std::uint32_t getRemainingTime() const;
+
+    /**
+     * Time left before the soft budget is spent, in milliseconds: none after abort(), a full turn when pondering.
+     */
+    std::uint32_t getRemainingSoftTime() const;
+
+    inline std::uint32_t getSoftTime() const
+    {
+        return m_softTime;
+    }
+
+    inline std::uint32_t getHardTime() const
+    {
+        return m_hardTime;
+    }
+
+    /**
+     * Time of a monotonic clock in milliseconds, from an unspecified origin: the clock of every search.
+     */
+    static inline std::uint64_t now()
+    {
+#ifdef __linux__
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#elif _WIN32
+        return static_cast<std::uint64_t>(std::clock()) * 1000 / CLOCKS_PER_SEC;
+#endif
+    }
+
+private:
+    void computeBudgets();
+
+    /**
+     * Time since the start of the turn, in milliseconds.
+     */
+    std::uint32_t elapsed() const;
+
+    // limits given by the manager, changed by the commands during a ponder search
+    std::atomic<std::uint32_t> m_turnTime;
+    std::atomic<std::uint32_t> m_matchTime;
+    std::atomic<std::uint32_t> m_timeLeft;
+    // the turn runs on the opponent time, its budgets are not used until the opponent moves
+    std::atomic<bool> m_pondering;
+    // the turn is over, there is no time left
+    std::atomic<bool> m_aborted;
+
+    // stones on the board at the start of the turn
+    int m_nbMoves;
+    // budgets of the turn, in milliseconds
+    std::uint32_t m_softTime;
+    std::uint32_t m_hardTime;
+    // soft budget after the adjustments of the iterations, in percents
+    int m_timePercent;
+    // recent changes of the best move, halved at each iteration, in percents of a change
+    int m_instability;
+    // last score of the odd and of the even depths, and whether they are set
+    int m_scores[2];
+    bool m_hasScores[2];
+
+    // see now()
+    std::uint64_t m_startTurn;
+};
+
+/**
+ * End of a search given a part of the turn, on the clock of the time manager: it is passed when the time of the search
+ * is up, or when the turn has no soft time left, at once when the turn is aborted.
+ */
+class Deadline {
+public:
+    Deadline()
+        : m_end(0)
+        , m_time(nullptr)
+    {
+    }
+
+    /**
+     * @param maxTime: time given to the search from now, in milliseconds.
+     * @param time: time manager of the turn, nullptr if the search only has its own time.
+     */
+    Deadline(std::uint32_t maxTime, const TimeManager *time)
+        : m_end(TimeManager::now() + maxTime)
+        , m_time(time)
+    {
+    }
+
+    inline bool isPassed() const
+    {
+        return TimeManager::now() >= m_end || (m_time && m_time->getRemainingSoftTime() == 0);
+    }
+
+private:
+    std::uint64_t m_end;
+    const TimeManager *m_time;
+};
+}
+
+#endif /* PPAY_TIME_MANAGER_HPP */
@@ -6,57 +6,211 @@
 #ifndef PPAY_TRANSPOSITION_TABLE_HPP
 #define PPAY_TRANSPOSITION_TABLE_HPP
 
-#include <algorithm>
-#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 
 namespace gmk::ppay {
 
-template <typename Key, typename Value>
+// number of entries in a bucket, the last one is always replaced, the others keep the deepest results
+#define TT_BUCKET_ENTRIES 4
+// number of distinct search generations, stored on 6 bits
+#define TT_GENERATIONS 64
+// depth lost by an entry for each search since it was stored, when choosing the entry to replace
+#define TT_AGE_DEPTH 4
+
+// meaning of a stored value regarding the real score of the position
+enum class TTBound : std::uint8_t {
+    none,
+    // the score is the value
+    exact,
+    // the score is at least the value (the search failed high)
+    lower,
+    // the score is at most the value (the search failed low)
+    upper,
+};
+
+struct TTEntry {
+    // full hash of the position, 0 for an empty entry
+    std::uint64_t key;
+    std::int32_t value;
+    // remaining depth of the search that stored the entry
+    std::int8_t depth;
+    // search generation (6 high bits) and bound (2 low bits)
+    std::uint8_t genBound;
+    // best move found, as a canonical cell of the position (see Position::canonicalCell()), -1 if none
+    std::int16_t move;
+
+    inline TTBound bound() const
+    {
+        return static_cast<TTBound>(genBound & 3);
+    }
+
+    inline int generation() const
+    {
+        return genBound >> 2;
+    }
+};
+
+/**
+ * Entry as stored in the table, shared by all the search threads without lock.
+ * The key is stored xored with the data: a slot written by two threads at once does not match any key anymore.
+ */
+struct TTSlot {
+    std::atomic<std::uint64_t> check;
+    // value (bits 0-31), depth (32-39), generation and bound (40-47), move (48-63), 0 for an empty slot
+    std::atomic<std::uint64_t> data;
+};
+
+// a bucket fills exactly one cache line so a probe costs one cache miss
+struct alignas(64) TTBucket {
+    TTSlot slots[TT_BUCKET_ENTRIES];
+};
+
+static_assert(sizeof(TTBucket) == 64, "a bucket must fill one cache line");
+
 class TranspositionTable {
 public:
-    TranspositionTable(std::size_t maxSize)
-        : m_maxSize(maxSize)
+    /**
+     * Allocates the table once, with the biggest power of two number of buckets fitting in memory.
+     *
+     * @param memory: memory limit of the table in bytes.
+     */
+    TranspositionTable(std::size_t memory)
+        : m_generation(0)
     {
+        resize(memory);
     }
 
-    inline bool get(const Key &key, int &value)
+    /**
+     * Starts a new search, the entries of the previous searches are kept but are replaced first.
+     */
+    inline void newSearch()
     {
-        auto it = m_table.find(key);
-        if (it != m_table.end()) {
-            value = it->second;
-            return true;
+        m_generation = (m_generation + 1) % TT_GENERATIONS;
+    }
+
+    /**
+     * Looks for a position in the table.
+     *
+     * @param key: hash of the position.
+     * @param entry: filled with the stored entry if found.
+     * @return true if the position is in the table.
+     */
+    inline bool probe(std::uint64_t key, TTEntry &entry) const
+    {
+        const TTBucket &bucket = m_buckets[key & m_mask];
+
+        // depth-preferred entries come first, so the deepest result is returned
+        for (const TTSlot &slot : bucket.slots) {
+            entry = load(slot);
+            if (entry.key == key && entry.genBound)
+                return true;
         }
         return false;
     }
 
-    inline void set(const Key &key, Value value)
+    inline void store(std::uint64_t key, int value, int depth, TTBound bound, int move)
     {
-        if (m_table.size() >= m_maxSize)
-            m_table.erase(m_table.begin());
-        m_table[key] = value;
+        TTBucket &bucket = m_buckets[key & m_mask];
+
+        // replace the same position or the least valuable depth-preferred entry, if the new result is worth more
+        TTSlot *replaced = &bucket.slots[0];
+        TTEntry replacedEntry = load(*replaced);
+        for (int i = 0; i < TT_BUCKET_ENTRIES - 1; i++) {
+            TTEntry entry = load(bucket.slots[i]);
+            if (entry.key == key || !entry.genBound) {
+                replaced = &bucket.slots[i];
+                replacedEntry = entry;
+                break;
+            }
+            if (worth(entry) < worth(replacedEntry)) {
+                replaced = &bucket.slots[i];
+                replacedEntry = entry;
+            }
+        }
+
+        // else the always-replace entry is used
+        if (replacedEntry.genBound && replacedEntry.key != key && depth < worth(replacedEntry))
+            replaced = &bucket.slots[TT_BUCKET_ENTRIES - 1];
+
+        std::uint64_t data = static_cast<std::uint32_t>(value);
+        data |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(depth)) << 32;
+        data |= static_cast<std::uint64_t>(m_generation << 2 | static_cast<int>(bound)) << 40;
+        data |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(move)) << 48;
+
+        replaced->check.store(key ^ data, std::memory_order_relaxed);
+        replaced->data.store(data, std::memory_order_relaxed);
     }
 
-    inline void resize(std::size_t maxSize)
+    /**
+     * Reallocates the table for a new memory limit, all entries are lost.
+     *
+     * @param memory: memory limit of the table in bytes.
+     */
+    inline void resize(std::size_t memory)
     {
-        if (maxSize < m_maxSize) {
-            m_table.erase(m_table.begin(), std::next(m_table.begin(), m_table.size() - maxSize));
-        }
-        m_maxSize = maxSize;
+        m_nbBuckets = 1;
+        while (m_nbBuckets * 2 * sizeof(TTBucket) <= memory)
+            m_nbBuckets *= 2;
+
+        m_buckets.reset();
+        m_buckets.reset(new TTBucket[m_nbBuckets]);
+        m_mask = m_nbBuckets - 1;
+        clear();
     }
 
     inline void clear()
     {
-        m_table.clear();
+        for (std::size_t i = 0; i < m_nbBuckets; i++) {
+            for (TTSlot &slot : m_buckets[i].slots) {
+                slot.check.store(0, std::memory_order_relaxed);
+                slot.data.store(0, std::memory_order_relaxed);
+            }
+        }
     }
 
-    inline std::size_t size() const
+    /**
+     * Number of entries of the table.
+     */
+    inline std::size_t capacity() const
     {
-        return m_table.size();
+        return m_nbBuckets * TT_BUCKET_ENTRIES;
     }
 
 private:
-    std::size_t m_maxSize;
-    std::unordered_map<Key, Value> m_table;
+    /**
+     * Reads a slot, the key of a slot being written by another thread is garbage.
+     */
+    static inline TTEntry load(const TTSlot &slot)
+    {
+        std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        TTEntry entry;
+        entry.key = check ^ data;
+        entry.value = static_cast<std::int32_t>(data & 0xffffffff);
+        entry.depth = static_cast<std::int8_t>((data >> 32) & 0xff);
+        entry.genBound = static_cast<std::uint8_t>((data >> 40) & 0xff);
+        entry.move = static_cast<std::int16_t>(data >> 48);
+        return entry;
+    }
+
+    /**
+     * Replacement priority of an entry: its depth, lowered by the number of searches since it was stored.
+     */
+    inline int worth(const TTEntry &entry) const
+    {
+        int age = (m_generation - entry.generation() + TT_GENERATIONS) % TT_GENERATIONS;
+        return entry.depth - age * TT_AGE_DEPTH;
+    }
+
+    std::unique_ptr<TTBucket[]> m_buckets;
+    std::size_t m_nbBuckets;
+    // number of buckets - 1, used to get the bucket of a key
+    std::size_t m_mask;
+    // generation of the current search
+    int m_generation;
 };
 
 }
@@ -0,0 +1,71 @@
+/**
+ * @file vcf.hpp
+ * @brief Victory by continuous fours search
+ */
+
+#ifndef PPAY_VCF_HPP
+#define PPAY_VCF_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "position.hpp"
+#include "time_manager.hpp"
+
+namespace gmk::ppay {
+
+// maximum number of fours of a sequence searched before the main search
+#define VCF_MAX_DEPTH 24
+// maximum number of positions visited by a search
+#define VCF_MAX_NODES 20000
+// part of the remaining time of the turn given to the search (1 / VCF_TIME_DIVISOR)
+#define VCF_TIME_DIVISOR 4
+// number of entries of the table of positions without victory (1 << VCF_TABLE_BITS)
+#define VCF_TABLE_BITS 15
+
+struct VCFEntry {
+    // zobrist hash of the position
+    std::uint64_t key;
+    // number of fours searched without finding a victory
+    int depth;
+};
+
+/**
+ * Searches a victory of the player to move made only of fours: each four leaves one reply to the defender,
+ * so the search is narrow enough to look very deep.
+ */
+class VCFSolver {
+public:
+    VCFSolver();
+
+    /**
+     * Searches a victory of the player to move.
+     *
+     * @param pos: position searched, restored before returning.
+     * @param maxDepth: maximum number of fours of the sequence.
+     * @param maxTime: time given to the search in milliseconds.
+     * @param move: set to the first move of the sequence if a victory is found.
+     * @param time: time manager of the turn, the search also stops when the turn has no time left.
+     * @return true if a victory is found.
+     */
+    bool solve(Position &pos, int maxDepth, std::uint32_t maxTime, Move &move, const TimeManager *time = nullptr);
+
+    inline int getNodeCount() const
+    {
+        return m_nodeCount;
+    }
+
+private:
+    bool search(Position &pos, int depth, Move &move);
+
+    // positions already searched without victory, replaced on collision
+    std::vector<VCFEntry> m_table;
+    // number of positions visited by the last search
+    int m_nodeCount;
+    // the node limit or the time is reached, the positions left are not searched
+    bool m_stop;
+    Deadline m_deadline;
+};
+}
+
+#endif /* PPAY_VCF_HPP */
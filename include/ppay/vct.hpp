@@ -0,0 +1,85 @@
+/**
+ * @file vct.hpp
+ * @brief Victory by continuous threats search
+ */
+
+#ifndef PPAY_VCT_HPP
+#define PPAY_VCT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "position.hpp"
+#include "time_manager.hpp"
+
+namespace gmk::ppay {
+
+// maximum number of threats of a sequence
+#define VCT_MAX_DEPTH 12
+// part of the remaining time of the turn given to the search (1 / VCT_TIME_DIVISOR)
+#define VCT_TIME_DIVISOR 4
+// number of entries of the table of proven and disproven positions (1 << VCT_TABLE_BITS)
+#define VCT_TABLE_BITS 16
+
+enum class VCTResult : std::uint8_t {
+    unknown,
+    // the attacker wins
+    proven,
+    // the attacker does not win within the depth
+    disproven,
+};
+
+struct VCTEntry {
+    // zobrist hash of the position
+    std::uint64_t key;
+    // number of threats searched: a proof holds for any bigger depth, a disproof for any smaller depth
+    int depth;
+    VCTResult result;
+    // first move of the victory of a proven position
+    Move move;
+};
+
+/**
+ * Searches a victory of the player to move made of fours and threes: the attacker only plays threats,
+ * the defender plays every move blocking them and every four of its own.
+ */
+class VCTSolver {
+public:
+    VCTSolver();
+
+    /**
+     * Searches a victory of the player to move, deeper and deeper until a victory is found or the time is up.
+     *
+     * @param pos: position searched, restored before returning.
+     * @param maxDepth: maximum number of threats of the sequence.
+     * @param maxTime: time given to the search in milliseconds.
+     * @param move: set to the first move of the sequence if a victory is found.
+     * @param time: time manager of the turn, the search also stops when the turn has no time left.
+     * @return true if a victory is found.
+     */
+    bool solve(Position &pos, int maxDepth, std::uint32_t maxTime, Move &move, const TimeManager *time = nullptr);
+
+    inline int getNodeCount() const
+    {
+        return m_nodeCount;
+    }
+
+private:
+    bool attack(Position &pos, int depth, Move &move);
+    bool defend(Position &pos, int depth);
+
+    /**
+     * Plays a move of the attacker, the result is the one of the defender position.
+     */
+    bool playAttack(Position &pos, const Move &move, int depth);
+
+    // proven and disproven positions, for the attacker of the current search only
+    std::vector<VCTEntry> m_table;
+    int m_nodeCount;
+    // the time is up, the results are not reliable anymore
+    bool m_stop;
+    Deadline m_deadline;
+};
+}
+
+#endif /* PPAY_VCT_HPP */
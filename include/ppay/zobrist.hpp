@@ -0,0 +1,46 @@
+/**
+ * @file zobrist.hpp
+ * @brief Random keys used to hash positions incrementally
+ */
+
+#ifndef PPAY_ZOBRIST_HPP
+#define PPAY_ZOBRIST_HPP
+
+#include <cstdint>
+
+#include "bitboard.hpp"
+
+namespace gmk::ppay {
+
+struct ZobristKeys {
+    // key of a stone of each player (0 = me, 1 = opponent) for each cell (x + y * MAX_BOARD_SIZE)
+    std::uint64_t stones[2][MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+    // key xored when the opponent is to move
+    std::uint64_t side;
+
+    ZobristKeys()
+    {
+        // fixed seed so hashes are the same from one run to another
+        std::uint64_t seed = 0x9e3779b97f4a7c15;
+
+        for (int player = 0; player < 2; player++)
+            for (int i = 0; i < MAX_BOARD_SIZE * MAX_BOARD_SIZE; i++)
+                stones[player][i] = next(seed);
+        side = next(seed);
+    }
+
+private:
+    // splitmix64 generator
+    static std::uint64_t next(std::uint64_t &seed)
+    {
+        std::uint64_t z = (seed += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+};
+
+inline const ZobristKeys zobristKeys;
+}
+
+#endif /* PPAY_ZOBRIST_HPP */
@@ -9,6 +9,10 @@ namespace gmk {
 
 BrainCore::BrainCore(const std::string &about)
     : m_about(about)
+    , m_thinking_thread_running(false)
+    , m_thinking_thread_started(false)
+    , m_need_thinking(false)
+    , m_pondering(false)
 {
     m_config = {
         .board_width = 20,
@@ -17,6 +21,9 @@ BrainCore::BrainCore(const std::string &about)
         .timeout_match = 180 * 1000, // in ms
         .max_memory = 70 * 1024 * 1024, // in KB
         .time_left = 180 * 1000, // in ms
+        .threads = std::max(1u, std::thread::hardware_concurrency()),
+        .ponder = false,
+        .proof = false,
         .game_type = Config::GameType::human_opponent,
         .rule = {
             .exactly_five = false,
@@ -73,23 +80,28 @@ void BrainCore::run()
 
 void BrainCore::startThinkingThread()
 {
-    std::mutex mutex;
-    std::unique_lock<std::mutex> lock(mutex);
-
     // start if not running
     if (!m_thinking_thread.joinable()) {
+        std::unique_lock<std::mutex> lock(m_thinking_mutex);
         m_thinking_thread_running = true;
+        m_thinking_thread_started = false;
+        m_need_thinking = false;
         m_thinking_thread = std::thread(&BrainCore::thinkingThread, this);
 
-        // wait for the thread to start
-        m_start_thinking_cond.wait(lock);
+        // wait for the thread to start, the flag keeps a confirmation sent before the wait
+        m_start_thinking_cond.wait(lock, [this] { return m_thinking_thread_started; });
     }
 }
 
 void BrainCore::stopThinkingThread()
 {
+    stopPondering();
+
     // stop if running
-    m_thinking_thread_running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_thinking_mutex);
+        m_thinking_thread_running = false;
+    }
     if (m_thinking_thread.joinable()) {
         m_need_thinking_cond.notify_one();
         m_thinking_thread.join();
@@ -98,26 +110,59 @@ void BrainCore::stopThinkingThread()
 
 void BrainCore::thinkingThread()
 {
-    std::mutex thinking_mutex;
-    std::unique_lock<std::mutex> lock(thinking_mutex);
+    std::unique_lock<std::mutex> lock(m_thinking_mutex);
 
     // confirm that we are running
+    m_thinking_thread_started = true;
     m_start_thinking_cond.notify_one();
-    // wait for the first move
-    m_need_thinking_cond.wait(lock);
-    while (m_running && m_thinking_thread_running) {
+    while (true) {
+        // wait for the next move, the flag keeps a move sent while we were thinking
+        m_need_thinking_cond.wait(lock, [this] { return m_need_thinking || !m_thinking_thread_running; });
+        if (!m_running || !m_thinking_thread_running)
+            break;
+        m_need_thinking = false;
+
+        lock.unlock();
         brainTurn();
-        // wait for the next move
-        m_need_thinking_cond.wait(lock);
+        lock.lock();
+
+        // think on the opponent time until the next command
+        if (m_config.ponder && !m_need_thinking && m_thinking_thread_running && brainPonderStart()) {
+            m_pondering = true;
+            lock.unlock();
+            brainPonder();
+            lock.lock();
+            m_pondering = false;
+            m_ponder_cond.notify_all();
+        }
     }
 }
 
 void BrainCore::startThinking()
 {
     // unlock thinking thread
+    {
+        std::lock_guard<std::mutex> lock(m_thinking_mutex);
+        m_need_thinking = true;
+    }
     m_need_thinking_cond.notify_one();
 }
 
+void BrainCore::stopPondering()
+{
+    std::unique_lock<std::mutex> lock(m_thinking_mutex);
+    stopPondering(lock);
+}
+
+void BrainCore::stopPondering(std::unique_lock<std::mutex> &lock)
+{
+    // abort the search on the opponent time and wait for its end
+    if (m_pondering) {
+        brainPonderStop();
+        m_ponder_cond.wait(lock, [this] { return !m_pondering; });
+    }
+}
+
 #define NEED_THINKING_THREAD_RUNNING                                                                                                                           \
     if (!m_thinking_thread_running) {                                                                                                                          \
         sendError("Thinking thread is not running");                                                                                                           \
@@ -131,6 +176,12 @@ void BrainCore::executeCommand(const std::string &command)
         IncomingVerb verb = std::get<0>(c);
         Arguments args = std::get<1>(c);
 
+        // the commands changing the game or the settings stop the search on the opponent time first,
+        // a turn decides by itself whether the search goes on (see brainOpponentMove())
+        if (verb != IncomingVerb::turn && verb != IncomingVerb::about && verb != IncomingVerb::info_timeout_turn
+            && verb != IncomingVerb::info_timeout_match && verb != IncomingVerb::info_time_left)
+            stopPondering();
+
         switch (verb) {
         // start and stop
         case IncomingVerb::start:
@@ -178,8 +229,15 @@ void BrainCore::executeCommand(const std::string &command)
                 break;
             }
             NEED_THINKING_THREAD_RUNNING;
-            if (brainOpponentMove(std::get<std::int32_t>(args[0]), std::get<std::int32_t>(args[1])))
-                startThinking();
+            {
+                // the thinking thread may be pondering, the move is given to the brain while it waits, and the turn is asked
+                // at once so the thread does not start pondering on the position with the move in between
+                std::unique_lock<std::mutex> lock(m_thinking_mutex);
+                if (!brainOpponentMove(std::get<std::int32_t>(args[0]), std::get<std::int32_t>(args[1])))
+                    break;
+                m_need_thinking = true;
+            }
+            m_need_thinking_cond.notify_one();
             break;
         case IncomingVerb::begin:
             NEED_THINKING_THREAD_RUNNING;
@@ -204,6 +262,9 @@ void BrainCore::executeCommand(const std::string &command)
         case IncomingVerb::board: {
             NEED_THINKING_THREAD_RUNNING;
 
+            // the board is set and the turn asked with the thinking thread waiting, it cannot ponder on a partial board
+            std::unique_lock<std::mutex> lock(m_thinking_mutex);
+            stopPondering(lock);
             bool hasError = false;
             // for 3 by 3 arguments
             for (std::uint32_t i = 0; i < args.size(); i += 3) {
@@ -235,7 +296,9 @@ void BrainCore::executeCommand(const std::string &command)
                     break;
             }
             if (!hasError)
-                startThinking();
+                m_need_thinking = true;
+            lock.unlock();
+            m_need_thinking_cond.notify_one();
         } break;
 
         // info and config
@@ -255,6 +318,18 @@ void BrainCore::executeCommand(const std::string &command)
             m_config.time_left = static_cast<uint32_t>(std::max(0, std::get<std::int32_t>(args[0])));
             brainInfo(InfoType::time_left);
             break;
+        case IncomingVerb::info_threads:
+            m_config.threads = static_cast<uint32_t>(std::max(1, std::get<std::int32_t>(args[0])));
+            brainInfo(InfoType::threads);
+            break;
+        case IncomingVerb::info_ponder:
+            m_config.ponder = std::get<std::int32_t>(args[0]) != 0;
+            brainInfo(InfoType::ponder);
+            break;
+        case IncomingVerb::info_proof:
+            m_config.proof = std::get<std::int32_t>(args[0]) != 0;
+            brainInfo(InfoType::proof);
+            break;
         case IncomingVerb::info_game_type: {
             std::uint32_t type = static_cast<uint32_t>(std::max(0, std::get<std::int32_t>(args[0])));
             if (type == 0) {
@@ -12,6 +12,9 @@ std::unordered_map<std::string, IncomingVerb> const string_incoming_verb_map = {
     { "INFO timeout_match", IncomingVerb::info_timeout_match },
     { "INFO max_memory", IncomingVerb::info_max_memory },
     { "INFO time_left", IncomingVerb::info_time_left },
+    { "INFO threads", IncomingVerb::info_threads },
+    { "INFO ponder", IncomingVerb::info_ponder },
+    { "INFO proof", IncomingVerb::info_proof },
     { "INFO game_type", IncomingVerb::info_game_type },
     { "INFO rule", IncomingVerb::info_rule },
     { "INFO folder", IncomingVerb::info_folder },
@@ -84,6 +87,24 @@ std::unordered_map<IncomingVerb, VerbConfig> const incoming_verb_config_map = {
             .type = PossibleTypes::integer,
             .multiLine = false,
         } },
+    { IncomingVerb::info_threads,
+        {
+            .numPerLine = 1,
+            .type = PossibleTypes::integer,
+            .multiLine = false,
+        } },
+    { IncomingVerb::info_ponder,
+        {
+            .numPerLine = 1,
+            .type = PossibleTypes::integer,
+            .multiLine = false,
+        } },
+    { IncomingVerb::info_proof,
+        {
+            .numPerLine = 1,
+            .type = PossibleTypes::integer,
+            .multiLine = false,
+        } },
     { IncomingVerb::info_game_type,
         {
             .numPerLine = 1,
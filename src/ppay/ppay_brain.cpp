@@ -19,6 +19,10 @@ PPayBrain::PPayBrain()
 {
     m_currentPos = nullptr;
     m_solver = nullptr;
+    m_ponderPos = nullptr;
+    m_ponderMove = Move(-1, -1);
+    m_ponderResult = Move(-1, -1);
+    m_ponderHit = false;
 }
 
 PPayBrain::~PPayBrain()
@@ -31,6 +35,10 @@ PPayBrain::~PPayBrain()
         delete m_solver;
         m_solver = nullptr;
     }
+    if (m_ponderPos) {
+        delete m_ponderPos;
+        m_ponderPos = nullptr;
+    }
 }
 
 bool PPayBrain::resetBoard()
@@ -39,6 +47,10 @@ bool PPayBrain::resetBoard()
         sendError("board size is 5x5");
         return false;
     }
+    if (m_config.board_width > MAX_BOARD_SIZE || m_config.board_height > MAX_BOARD_SIZE) {
+        sendError("board size is too big");
+        return false;
+    }
     if (m_currentPos) {
         delete m_currentPos;
     }
@@ -46,7 +58,12 @@ bool PPayBrain::resetBoard()
         delete m_solver;
     }
     m_currentPos = new Position(m_config.board_width, m_config.board_height);
-    m_solver = new Solver(m_config.board_width, m_config.board_height, m_config.max_memory, m_config.timeout_turn);
+    m_solver = new Solver(m_config.board_width, m_config.board_height, m_config.max_memory, m_config.timeout_turn, m_config.threads);
+    m_solver->setMatchTime(m_config.timeout_match);
+    m_solver->setTimeLeft(m_config.time_left);
+    m_solver->setMode(m_config.proof ? SolverMode::proof : SolverMode::search);
+    m_ponderMove = Move(-1, -1);
+    m_ponderHit = false;
     return true;
 }
 
@@ -73,10 +90,29 @@ bool PPayBrain::brainRestart()
 // callback for info update
 void PPayBrain::brainInfo(const InfoType &info)
 {
+    // infos received before START are read from the config when the solver is created
+    if (!m_solver)
+        return;
+
     switch (info) {
     case InfoType::timeout_turn:
         m_solver->setMaxTime(m_config.timeout_turn);
         break;
+    case InfoType::timeout_match:
+        m_solver->setMatchTime(m_config.timeout_match);
+        break;
+    case InfoType::time_left:
+        m_solver->setTimeLeft(m_config.time_left);
+        break;
+    case InfoType::max_memory:
+        m_solver->setMaxMemory(m_config.max_memory);
+        break;
+    case InfoType::threads:
+        m_solver->setThreads(m_config.threads);
+        break;
+    case InfoType::proof:
+        m_solver->setMode(m_config.proof ? SolverMode::proof : SolverMode::search);
+        break;
     default:
         break;
     }
@@ -90,11 +126,63 @@ void PPayBrain::brainTurn()
         return;
     }
 
+    // the ponder search went on with the time of the turn after the expected reply
+    if (m_ponderHit) {
+        m_ponderHit = false;
+        m_solver->stopPonder();
+        doMyMove(m_ponderResult.first, m_ponderResult.second);
+        return;
+    }
+
+    m_solver->stopPonder();
     m_currentPos->setIsMyTurn(true);
     Move bestMove = m_solver->findBestMove(*m_currentPos);
     doMyMove(bestMove.first, bestMove.second);
 }
 
+// prepare the search on the opponent time, the commands wait for the thinking lock held by the caller
+bool PPayBrain::brainPonderStart()
+{
+    if (!m_currentPos || !m_solver)
+        return false;
+
+    // search our answer to the expected reply, or every reply of the opponent if it is unknown
+    if (m_ponderPos)
+        delete m_ponderPos;
+    m_ponderPos = new Position(*m_currentPos);
+    m_ponderPos->setIsMyTurn(false);
+    m_ponderMove = m_solver->getPonderMove(*m_ponderPos);
+    if (m_ponderMove.first != -1)
+        m_ponderPos->play(m_ponderMove.first, m_ponderMove.second, false);
+    m_ponderPos->setIsMyTurn(m_ponderMove.first != -1);
+    if (m_ponderPos->getNbCandidates() == 0) {
+        m_ponderMove = Move(-1, -1);
+        return false;
+    }
+
+    m_ponderHit = false;
+    m_solver->startPonder(*m_ponderPos);
+    return true;
+}
+
+// search on the opponent time, until the opponent moves
+void PPayBrain::brainPonder()
+{
+    Move result = m_solver->findBestMove(*m_ponderPos);
+
+    // the search is over, a reply coming after it is searched again on our own time, even the expected one
+    std::lock_guard<std::mutex> lock(m_thinking_mutex);
+    m_ponderResult = result;
+    m_ponderMove = Move(-1, -1);
+}
+
+// abort the search on the opponent time, its result will not be used
+void PPayBrain::brainPonderStop()
+{
+    m_ponderMove = Move(-1, -1);
+    m_solver->abort();
+}
+
 bool PPayBrain::isFree(std::uint32_t x, std::uint32_t y)
 {
     return x < m_config.board_width && y < m_config.board_height && m_currentPos->canPlay(x, y);
@@ -123,6 +211,14 @@ bool PPayBrain::brainOpponentMove(std::uint32_t x, std::uint32_t y)
         return false;
     }
     if (isFree(x, y)) {
+        // the running ponder search goes on as the search of the turn if the expected reply is played, else it is dropped
+        if (m_pondering && m_ponderMove == Move(x, y)) {
+            m_ponderHit = true;
+            m_solver->ponderHit();
+        } else if (m_pondering) {
+            m_solver->abort();
+        }
+        m_ponderMove = Move(-1, -1);
         m_currentPos->play(x, y, false);
         return true;
     }
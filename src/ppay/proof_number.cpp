@@ -0,0 +1,194 @@
+#include <algorithm>
+
+#include "ppay/proof_number.hpp"
+#include "ppay/zobrist.hpp"
+
+namespace gmk::ppay {
+
+// the clock is read once every PN_TIME_CHECK positions
+#define PN_TIME_CHECK 256
+
+PNSolver::PNSolver(std::size_t memory)
+    : m_attacker(true)
+    , m_nodeCount(0)
+    , m_maxNodes(0)
+    , m_stop(false)
+{
+    resize(memory);
+    m_moves.reserve(MAX_BOARD_SIZE * MAX_BOARD_SIZE);
+}
+
+void PNSolver::resize(std::size_t memory)
+{
+    std::size_t nbEntries = 1;
+    while (nbEntries * 2 * sizeof(PNEntry) <= memory)
+        nbEntries *= 2;
+    m_table.reset();
+    m_table.reset(new PNEntry[nbEntries]);
+    m_mask = nbEntries - 1;
+}
+
+PNResult PNSolver::solve(Position &pos, int maxNodes, std::uint32_t maxTime, Move &move, const TimeManager *time)
+{
+    bool player = pos.isMyTurn();
+    m_nodeCount = 0;
+
+    if (prove(pos, player, maxNodes / 2, maxTime / 2, time)) {
+        // the winning move is a child proven as well
+        std::uint64_t key = pos.zobristHash();
+        for (int i = 0; i < pos.getNbCandidates(); i++) {
+            Move candidate = pos.getCandidate(i);
+            std::uint32_t pn;
+            std::uint32_t dn;
+            lookup(key ^ zobristKeys.stones[player ? 0 : 1][candidate.first + candidate.second * MAX_BOARD_SIZE] ^ zobristKeys.side, pn, dn);
+            if (pn == 0) {
+                move = candidate;
+                return PNResult::win;
+            }
+        }
+    }
+
+    return prove(pos, !player, maxNodes / 2, maxTime / 2, time) ? PNResult::loss : PNResult::unknown;
+}
+
+bool PNSolver::prove(Position &pos, bool attacker, int maxNodes, std::uint32_t maxTime, const TimeManager *time)
+{
+    // the numbers depend on the attacker, the table is only kept during one proof
+    std::fill(m_table.get(), m_table.get() + m_mask + 1, PNEntry { 0, 0, 0 });
+    m_attacker = attacker;
+    m_maxNodes = m_nodeCount + maxNodes;
+    m_stop = false;
+    m_moves.clear();
+    m_deadline = Deadline(maxTime, time);
+
+    mid(pos, PN_INFINITY, PN_INFINITY);
+
+    std::uint32_t pn;
+    std::uint32_t dn;
+    lookup(pos.zobristHash(), pn, dn);
+    return pn == 0;
+}
+
+void PNSolver::mid(Position &pos, std::uint32_t thpn, std::uint32_t thdn)
+{
+    if (++m_nodeCount >= m_maxNodes || (m_nodeCount % PN_TIME_CHECK == 0 && m_deadline.isPassed()))
+        m_stop = true;
+    if (m_stop)
+        return;
+
+    std::uint64_t key = pos.zobristHash();
+    std::uint32_t pn;
+    std::uint32_t dn;
+    lookup(key, pn, dn);
+    if (pn >= thpn || dn >= thdn)
+        return;
+
+    // the moves of the node are pushed on the stack shared with the nodes below, and popped before returning
+    std::size_t first = m_moves.size();
+    if (!generateMoves(pos, pn, dn)) {
+        store(key, pn, dn);
+        return;
+    }
+    std::size_t last = m_moves.size();
+
+    // the attacker needs one proven move, the defender one disproven move
+    bool isOrNode = pos.isMyTurn() == m_attacker;
+    int player = pos.isMyTurn() ? 0 : 1;
+
+    while (true) {
+        // the numbers of the node are computed from its children
+        std::uint64_t sum = 0;
+        std::uint32_t best = PN_INFINITY;
+        std::uint32_t second = PN_INFINITY;
+        std::uint32_t bestOther = 0;
+        std::size_t bestIndex = first;
+
+        for (std::size_t i = first; i < last; i++) {
+            std::uint32_t childPn;
+            std::uint32_t childDn;
+            lookup(key ^ zobristKeys.stones[player][m_moves[i].first + m_moves[i].second * MAX_BOARD_SIZE] ^ zobristKeys.side, childPn, childDn);
+
+            // an or node minimizes the proof numbers and sums the disproof numbers, an and node does the opposite
+            std::uint32_t minimized = isOrNode ? childPn : childDn;
+            std::uint32_t summed = isOrNode ? childDn : childPn;
+            if (minimized < best) {
+                second = best;
+                best = minimized;
+                bestOther = summed;
+                bestIndex = i;
+            } else if (minimized < second) {
+                second = minimized;
+            }
+            sum += summed;
+        }
+        std::uint32_t total = static_cast<std::uint32_t>(std::min<std::uint64_t>(sum, PN_INFINITY));
+
+        pn = isOrNode ? best : total;
+        dn = isOrNode ? total : best;
+        store(key, pn, dn);
+        if (pn >= thpn || dn >= thdn || m_stop)
+            break;
+
+        // search the most proving child until it is not the best anymore
+        std::uint32_t thMinimized = std::min(isOrNode ? thpn : thdn, second + 1);
+        std::uint64_t thSummed = static_cast<std::uint64_t>(isOrNode ? thdn : thpn) - total + bestOther;
+        std::uint32_t childThSummed = static_cast<std::uint32_t>(std::min<std::uint64_t>(thSummed, PN_INFINITY));
+
+        Move move = m_moves[bestIndex];
+        pos.makeMove(move.first, move.second);
+        if (isOrNode)
+            mid(pos, thMinimized, childThSummed);
+        else
+            mid(pos, childThSummed, thMinimized);
+        pos.unmakeMove();
+    }
+    m_moves.resize(first);
+}
+
+bool PNSolver::generateMoves(const Position &pos, std::uint32_t &pn, std::uint32_t &dn)
+{
+    bool isMyTurn = pos.isMyTurn();
+    bool attackerToMove = isMyTurn == m_attacker;
+    bool hasFive = pos.getThreatCells(isMyTurn, ThreatType::five).any();
+    const Bitboard &losses = pos.getThreatCells(!isMyTurn, ThreatType::five);
+    int nbLosses = losses.count();
+
+    // the player to move wins at once, or cannot block two fives
+    if (hasFive || nbLosses >= 2) {
+        bool attackerWins = hasFive == attackerToMove;
+        pn = attackerWins ? 0 : PN_INFINITY;
+        dn = attackerWins ? PN_INFINITY : 0;
+        return false;
+    }
+
+    Bitboard cells;
+    if (nbLosses == 1) {
+        // a four has a single reply
+        cells = losses;
+    } else if (attackerToMove) {
+        // an open four wins, the other moves of the attacker are threats, and a three is too slow against a three
+        if (pos.getThreatCells(isMyTurn, ThreatType::openFour).any()) {
+            pn = 0;
+            dn = PN_INFINITY;
+            return false;
+        }
+        cells = pos.getThreatCells(isMyTurn, ThreatType::four);
+        if (!pos.getThreatCells(!isMyTurn, ThreatType::openFour).any())
+            cells |= pos.getThreatCells(isMyTurn, ThreatType::openThree) | pos.getThreatCells(isMyTurn, ThreatType::brokenThree);
+    } else {
+        // the defender blocks the three of the attacker or makes a four, unless its own three is faster
+        const Bitboard &openFours = pos.getThreatCells(!isMyTurn, ThreatType::openFour);
+        if (openFours.any() && !pos.getThreatCells(isMyTurn, ThreatType::openFour).any())
+            cells = openFours | pos.getThreatCells(!isMyTurn, ThreatType::four) | pos.getThreatCells(isMyTurn, ThreatType::four);
+    }
+
+    // without threat left, the attacker has lost the initiative: the position is not proven
+    if (!cells.any()) {
+        pn = PN_INFINITY;
+        dn = 0;
+        return false;
+    }
+    cells.forEach([&](int index) { m_moves.push_back(pos.getCell(index)); });
+    return true;
+}
+}
@@ -1,218 +1,463 @@
+#include <algorithm>
 #include <climits>
 #include <iostream>
+#include <thread>
 
+#include "ppay/move_picker.hpp"
 #include "ppay/position.hpp"
 #include "ppay/solver.hpp"
 #include "ppay/transposition_table.hpp"
 
 namespace gmk::ppay {
 
-Solver::Solver(int width, int height, uint32_t max_memory, uint32_t maxTime)
-    : m_tt(500000)
+// helper threads skip some depths of the iterative deepening, so the threads do not all search the same depth at the same time
+static const int skipSize[] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const int skipPhase[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+#define SKIP_TABLE_SIZE static_cast<int>(sizeof(skipSize) / sizeof(skipSize[0]))
+
+Solver::Solver(int width, int height, uint32_t max_memory, uint32_t maxTime, uint32_t threads)
+    : m_tt(getTTMemory(max_memory))
+    , m_pn(getPNMemory(max_memory))
+    , m_mode(SolverMode::search)
+    , m_proofResult(PNResult::unknown)
+    , m_useLMR(true)
+    , m_useNullMove(true)
+    , m_useProbCut(true)
     , m_width(width)
     , m_height(height)
     , m_maxMemory(max_memory)
-    , m_maxTime(maxTime)
-    , m_depthLimit(2)
-    , m_awayLimit(3)
+    , m_resizePending(false)
+    , m_time(maxTime)
+    , m_depthLimit(MAX_DEPTH)
+    , m_stop(false)
 {
+    setThreads(threads);
 }
 
 Solver::~Solver()
 {
 }
 
-void Solver::generateMovesOrder(const Position &pos)
+int Solver::negamax(SearchThread &thread, int deep, int ply, int alpha, int beta, bool allowNullMove)
 {
-    m_moveOrder.clear();
-
-    // from center to corners
-    for (int y = 0; y < m_height; ++y) {
-        int _y = m_height / 2 + (1 - 2 * (y % 2)) * (y + 1) / 2;
-        for (int x = 0; x < m_width; ++x) {
-            int _x = m_width / 2 + (1 - 2 * (x % 2)) * (x + 1) / 2;
-            if (pos.canPlay(_x, _y)) {
-                m_moveOrder.push_back(Move(_x, _y));
+    Position &pos = thread.pos;
+
+    // if depth limit is reached, return the heuristic value once the fours on board are played
+    if (deep == 0)
+        return quiescence(thread, QS_MAX_DEPTH, alpha, beta);
+
+    // max time is reached, abort the search, the result of the iteration is dropped
+    // only the main thread checks the clock, the helpers stop with it
+    if (m_stop.load(std::memory_order_relaxed) || (thread.id == 0 && getRemainingTime() == 0)) {
+        m_stop = true;
+        return 0;
+    }
+    thread.nodeCount++;
+
+    // if the position is in the transposition table, use its bounds if they are deep enough
+    // and search its best move first
+    std::uint64_t hash = pos.hash();
+    int alphaOrig = alpha;
+    int betaOrig = beta;
+    Move ttMove = Move(-1, -1);
+    TTEntry entry;
+    if (m_tt.probe(hash, entry)) {
+        if (entry.move >= 0)
+            ttMove = pos.fromCanonicalCell(entry.move);
+
+        if (entry.depth >= deep) {
+            if (entry.bound() == TTBound::exact)
+                return entry.value;
+            if (entry.bound() == TTBound::lower)
+                alpha = std::max(alpha, entry.value);
+            else if (entry.bound() == TTBound::upper)
+                beta = std::min(beta, entry.value);
+            if (beta <= alpha)
+                return entry.value;
+        }
+    }
+
+    bool isMyTurn = pos.isMyTurn();
+
+    // if we have a winning move, play it
+    const Bitboard &wins = pos.getThreatCells(isMyTurn, ThreatType::five);
+    if (wins.any()) {
+        Move winningMove = pos.getCell(wins.first());
+        // a win is exact whatever the depth
+        m_tt.store(hash, SCORE_WIN, MAX_DEPTH, TTBound::exact, pos.canonicalCell(winningMove.first, winningMove.second));
+        return SCORE_WIN;
+    }
+
+    // if there is more than one loosing move, it's impossible to counter both, it's a instant loose
+    const Bitboard &losses = pos.getThreatCells(!isMyTurn, ThreatType::five);
+    if (losses.count() >= 2) {
+        Move loosingMove = pos.getCell(losses.first());
+        // store the value in the transposition table
+        m_tt.store(hash, -SCORE_WIN, MAX_DEPTH, TTBound::exact, pos.canonicalCell(loosingMove.first, loosingMove.second));
+        return -SCORE_WIN;
+    }
+
+    // null move pruning: if passing the turn still fails high with a reduced search, a move would too
+    // not against a four or a three, not twice in a row, and not in the principal variation
+    bool isPV = alpha + 1 < beta;
+    if (m_useNullMove && allowNullMove && !isPV && deep >= NULL_MOVE_MIN_DEPTH && !losses.any()
+        && !pos.getThreatCells(!isMyTurn, ThreatType::openFour).any() && (isMyTurn ? pos.heuristic() : -pos.heuristic()) >= beta) {
+        pos.makeNullMove();
+        int score = -negamax(thread, std::max(deep - 1 - NULL_MOVE_REDUCTION, 0), ply + 1, -beta, -beta + 1, false);
+        pos.unmakeNullMove();
+        if (m_stop.load(std::memory_order_relaxed))
+            return 0;
+        // a win found without moving is not proven
+        if (score >= beta)
+            return score >= SCORE_WIN ? beta : score;
+    }
+
+    // probcut: the score of a shallow search predicts the score of the deep one, the node is cut
+    // when the shallow score is high enough for the deep one to be above beta with confidence
+    if (m_useProbCut && !isPV && deep >= PROBCUT_MIN_DEPTH && !losses.any() && !pos.getThreatCells(!isMyTurn, ThreatType::openFour).any()) {
+        int probBeta = probCutBound(beta);
+        if (probBeta < SCORE_WIN) {
+            int score = negamax(thread, deep - PROBCUT_REDUCTION, ply, probBeta - 1, probBeta, allowNullMove);
+            if (m_stop.load(std::memory_order_relaxed))
+                return 0;
+            if (score >= probBeta)
+                return beta;
+        }
+    }
+
+    // fitting mode: the (shallow, deep) score pairs of the principal variation nodes fit the parameters of probcut
+    int shallowScore = -SCORE_INFINITY;
+    bool logProbCut = thread.id == 0 && isPV && deep >= PROBCUT_MIN_DEPTH && m_probCutLog.is_open();
+    if (logProbCut) {
+        shallowScore = negamax(thread, deep - PROBCUT_REDUCTION, ply, alphaOrig, betaOrig, allowNullMove);
+        if (m_stop.load(std::memory_order_relaxed))
+            return 0;
+    }
+
+    // scores are seen from the player to move, the best move has the highest one
+    int bestScore = -SCORE_WIN;
+    Move bestMove = Move(-1, -1);
+
+    // the moves come from the most to the least promising, a cutoff skips the generation of the next ones
+    int side = isMyTurn ? 0 : 1;
+    Move *killers = thread.killers[ply];
+    MovePicker picker(pos, ttMove, killers, thread.history[side], &thread.quiets[ply * pos.getNbCells()]);
+    Move move;
+    int nbSearched = 0;
+
+    // calculate the score for each move
+    while (picker.next(move)) {
+        // play move in place
+        pos.makeMove(move.first, move.second);
+
+        // the first move is searched with the full window, the next ones are only proven worse with a null window,
+        // and searched again with the full window if they are not
+        int score;
+        if (nbSearched == 0) {
+            score = -negamax(thread, deep - 1, ply + 1, -beta, -alpha, true);
+        } else {
+            // the late quiet moves are first searched less deep, and at full depth if they beat alpha
+            int reduction = 0;
+            if (m_useLMR && picker.isQuiet() && deep >= LMR_MIN_DEPTH && nbSearched >= LMR_MIN_MOVES)
+                reduction = std::min(nbSearched >= LMR_LATE_MOVES ? 2 : 1, deep - 2);
+
+            score = -negamax(thread, deep - 1 - reduction, ply + 1, -alpha - 1, -alpha, true);
+            if (reduction && score > alpha)
+                score = -negamax(thread, deep - 1, ply + 1, -alpha - 1, -alpha, true);
+            if (score > alpha && score < beta)
+                score = -negamax(thread, deep - 1, ply + 1, -beta, -alpha, true);
+        }
+        pos.unmakeMove();
+        nbSearched++;
+        if (m_stop.load(std::memory_order_relaxed))
+            return 0;
+
+        // update the best score
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        alpha = std::max(alpha, score);
+        // if the beta cut-off is reached, return the best score
+        if (alpha >= beta) {
+            // the move will be tried early in the other positions
+            if (move != killers[0]) {
+                for (int k = NB_KILLERS - 1; k > 0; k--)
+                    killers[k] = killers[k - 1];
+                killers[0] = move;
             }
+            thread.history[side][move.first + move.second * MAX_BOARD_SIZE] += deep * deep;
+            break;
         }
     }
+
+    if (logProbCut && shallowScore > alphaOrig && shallowScore < betaOrig && bestScore > alphaOrig && bestScore < betaOrig)
+        m_probCutLog << deep << " " << shallowScore << " " << bestScore << std::endl;
+
+    // store the best score in the transposition table, with the bound given by the search window
+    TTBound bound = bestScore <= alphaOrig ? TTBound::upper : bestScore >= betaOrig ? TTBound::lower : TTBound::exact;
+    m_tt.store(hash, bestScore, deep, bound, bestMove.first == -1 ? -1 : pos.canonicalCell(bestMove.first, bestMove.second));
+    return bestScore;
 }
 
-int Solver::minimax(const Position &pos, int deep, int alpha, int beta, bool maximizingPlayer)
+int Solver::quiescence(SearchThread &thread, int qdepth, int alpha, int beta)
 {
-    // if depth limit is reached, return the heuristic value
-    if (deep == 0)
-        return pos.heuristic();
+    Position &pos = thread.pos;
+    bool isMyTurn = pos.isMyTurn();
+    thread.nodeCount++;
+
+    // if we have a winning move, the position is won
+    if (pos.getThreatCells(isMyTurn, ThreatType::five).any())
+        return SCORE_WIN;
+
+    // against a four, the only move is to block it, against two the position is lost
+    const Bitboard &losses = pos.getThreatCells(!isMyTurn, ThreatType::five);
+    int nbLosses = losses.count();
+    if (nbLosses >= 2)
+        return -SCORE_WIN;
+    if (nbLosses == 1 && qdepth > 0) {
+        Move block = pos.getCell(losses.first());
+        pos.makeMove(block.first, block.second);
+        int score = -quiescence(thread, qdepth - 1, -beta, -alpha);
+        pos.unmakeMove();
+        return score;
+    }
 
-    // max time is reached, return the heuristic value
-    if (getRemainingTime() == 0)
-        return pos.heuristic();
+    // an open four wins, unless the opponent can answer with fours
+    const Bitboard &openFours = pos.getThreatCells(isMyTurn, ThreatType::openFour);
+    if (nbLosses == 0 && openFours.any() && !pos.getThreatCells(!isMyTurn, ThreatType::four).any()
+        && !pos.getThreatCells(!isMyTurn, ThreatType::openFour).any())
+        return SCORE_WIN;
+
+    // the player to move may stop playing fours and keep the heuristic value (stand pat)
+    int bestScore = isMyTurn ? pos.heuristic() : -pos.heuristic();
+    if (bestScore >= beta || nbLosses || qdepth == 0)
+        return bestScore;
+    alpha = std::max(alpha, bestScore);
+
+    // else only the fours are searched, each of them leaves a single reply
+    Bitboard fours = pos.getThreatCells(isMyTurn, ThreatType::four) | openFours;
+    while (fours.any()) {
+        int index = fours.first();
+        fours.reset(index);
+
+        Move move = pos.getCell(index);
+        pos.makeMove(move.first, move.second);
+        int score = -quiescence(thread, qdepth - 1, -beta, -alpha);
+        pos.unmakeMove();
+
+        bestScore = std::max(bestScore, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta)
+            break;
+    }
+    return bestScore;
+}
 
-    // if the position is in the transposition table, return the value
-    int score;
-    if (m_tt.get(pos.hash(), score))
-        return score;
+int Solver::searchRoot(SearchThread &thread, int depth, int alpha, int beta)
+{
+    Position &pos = thread.pos;
+    int bestScore = -SCORE_INFINITY;
+
+    // the moves left unsearched by a cutoff go last in the next search
+    for (auto &rootMove : thread.rootMoves)
+        rootMove.score = -SCORE_INFINITY;
+
+    // the best move of the previous search is searched with the full window, the others with a null window
+    // above the best score so far, a move is only searched again if it proves better
+    for (std::size_t i = 0; i < thread.rootMoves.size(); i++) {
+        RootMove &rootMove = thread.rootMoves[i];
+        pos.makeMove(rootMove.move.first, rootMove.move.second);
+        int score;
+        if (i == 0) {
+            score = -negamax(thread, depth - 1, 1, -beta, -alpha, true);
+        } else {
+            score = -negamax(thread, depth - 1, 1, -alpha - 1, -alpha, true);
+            if (score > alpha && score < beta)
+                score = -negamax(thread, depth - 1, 1, -beta, -alpha, true);
+        }
+        pos.unmakeMove();
 
-    // if there is more than 6 moves on board, check if there is a winning move
-    if (pos.getNbMoves() > 6) {
-        Move loosingMove = Move(-1, -1);
-        int loosingMoveCount = 0;
+        if (m_stop.load(std::memory_order_relaxed))
+            return bestScore;
 
-        for (const auto &move : m_moveOrder) {
-            int x = move.first;
-            int y = move.second;
+        // the score of a move worse than the best one is only an upper bound, it still orders the next search
+        rootMove.score = score;
+        bestScore = std::max(bestScore, score);
+        alpha = std::max(alpha, score);
+        if (alpha >= beta)
+            break;
+    }
+
+    // search the next iteration from the best move of this one
+    std::stable_sort(thread.rootMoves.begin(), thread.rootMoves.end(), [](const RootMove &a, const RootMove &b) { return a.score > b.score; });
+    return bestScore;
+}
 
-            // play only moves that are not too far away
-            if (isTooFar(pos, x, y))
+void Solver::iterativeDeepening(SearchThread &thread)
+{
+    Position &pos = thread.pos;
+    int maxDepth = std::min(m_depthLimit, pos.getNbCells() - pos.getNbMoves());
+    // last score of the odd and of the even depths
+    int previousScores[2] = { 0, 0 };
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        // helper threads skip some depths, depending on their id
+        if (thread.id > 0) {
+            int i = (thread.id - 1) % SKIP_TABLE_SIZE;
+            if (((depth + skipPhase[i]) / skipSize[i]) % 2)
                 continue;
+        }
 
-            if (pos.canPlay(x, y)) {
-                // if we have a winning move, play it
-                if (pos.isWinningMove(x, y)) {
-                    score = maximizingPlayer ? INT_MAX - 1 : INT_MIN + 1;
-                    // store the value in the transposition table
-                    m_tt.set(pos.hash(), score);
-                    return score;
-                }
-
-                // if there is a losing move, save it
-                if (pos.isWinningMove(x, y, false)) {
-                    loosingMove = Move(x, y);
-                    loosingMoveCount++;
-                }
-            }
+        // the score rarely moves much from one iteration to the next of the same parity (the player making the last move
+        // of the search is favored): search a narrow window around it first, and widen the bound it fails on until the score falls inside
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -SCORE_INFINITY;
+        int beta = SCORE_INFINITY;
+        int previousScore = previousScores[depth % 2];
+        if (thread.completedDepth >= ASPIRATION_MIN_DEPTH) {
+            alpha = previousScore > -SCORE_INFINITY + delta ? previousScore - delta : -SCORE_INFINITY;
+            beta = previousScore < SCORE_INFINITY - delta ? previousScore + delta : SCORE_INFINITY;
         }
 
-        // if no winning move are found, we should block loosing move
-        if (loosingMoveCount == 1) {
-            Position newPos(pos);
-            newPos.play(loosingMove.first, loosingMove.second);
+        int score;
+        while (true) {
+            score = searchRoot(thread, depth, alpha, beta);
+            if (m_stop.load(std::memory_order_relaxed))
+                break;
 
-            // calculate the score
-            return minimax(newPos, deep - 1, alpha, beta, !maximizingPlayer);
-        }
-        // if there is more than one loosing move, it's impossible to counter both, it's a instant loose
-        if (loosingMoveCount >= 2) {
-            score = maximizingPlayer ? INT_MIN + 1 : INT_MAX - 1;
-            // store the value in the transposition table
-            m_tt.set(pos.hash(), score);
-            return score;
+            if (score <= alpha && alpha > -SCORE_INFINITY)
+                alpha = score > -SCORE_INFINITY + delta ? score - delta : -SCORE_INFINITY;
+            else if (score >= beta && beta < SCORE_INFINITY)
+                beta = score < SCORE_INFINITY - delta ? score + delta : SCORE_INFINITY;
+            else
+                break;
+            delta = delta >= SCORE_INFINITY / 4 ? SCORE_INFINITY : delta * 2;
         }
-    }
 
-    // if we are in the maximizing player's turn, find the best move
-    // else, find the worst move
-    int bestScore = maximizingPlayer ? INT_MIN + 1 : INT_MAX - 1;
+        // an unfinished iteration is not reliable, keep the move of the last complete one
+        if (m_stop.load(std::memory_order_relaxed))
+            break;
 
-    // calculate the score for each move
-    for (const auto &move : m_moveOrder) {
-        int x = move.first;
-        int y = move.second;
-
-        // play only moves that are not too far away
-        if (isTooFar(pos, x, y))
-            continue;
-
-        // ignore moves that are not playable
-        if (pos.canPlay(x, y)) {
-            // play move in new board
-            Position newPos(pos);
-            newPos.play(x, y);
-
-            // calculate the score
-            score = minimax(newPos, deep - 1, alpha, beta, !maximizingPlayer);
-
-            // update the best score
-            if (maximizingPlayer) {
-                bestScore = std::max(bestScore, score);
-                alpha = std::max(alpha, score);
-            } else {
-                bestScore = std::min(bestScore, score);
-                beta = std::min(beta, score);
-            }
-            // if the beta cut-off is reached, return the best score
-            if (beta <= alpha)
-                break;
+        previousScores[depth % 2] = score;
+        bool bestMoveChanged = thread.completedDepth > 0 && thread.bestMove != thread.rootMoves.front().move;
+        thread.bestMove = thread.rootMoves.front().move;
+        thread.completedDepth = depth;
+
+        // no need to go deeper once a forced result is found, for any thread
+        if (score >= SCORE_WIN || score <= -SCORE_WIN) {
+            m_stop = true;
+            break;
+        }
+
+        // with a match limit, the main thread does not start an iteration it would likely not end within the soft budget
+        // a ponder search goes on until the opponent moves
+        if (thread.id == 0 && !m_time.isPondering() && m_time.shouldStop(depth, bestMoveChanged, score)) {
+            m_stop = true;
+            break;
         }
     }
 
-    // store the best score in the transposition table
-    m_tt.set(pos.hash(), bestScore);
-    return bestScore;
+    // the helpers search until the main thread is done
+    if (thread.id == 0)
+        m_stop = true;
 }
 
 Move Solver::findBestMove(const Position &pos)
 {
+    m_proofResult = PNResult::unknown;
+
     // first move is always at center
     if (pos.getNbMoves() == 0)
         return std::make_pair(m_width / 2, m_height / 2);
 
-    // start chronometer    
-#ifdef __linux__
-    m_startTurn = std::chrono::steady_clock::now();
-#elif _WIN32
-    m_startTurn = std::clock();
-#endif
-
-    // reset transposition table and move order
-    m_nodeCount = 0;
-    m_tt.clear();
-    generateMovesOrder(pos);
-
-    // if there is more than 6 moves on board, check if there is a winning move
-    if (pos.getNbMoves() > 6) {
-        Move loosingMove = Move(-1, -1);
-        for (const auto &move : m_moveOrder) {
-            int x = move.first;
-            int y = move.second;
-
-            // play only moves that are not too far away
-            if (isTooFar(pos, x, y))
-                continue;
-
-            if (pos.canPlay(x, y)) {
-                // if we have a winning move, play it
-                if (pos.isWinningMove(x, y))
-                    return Move(x, y);
-
-                // if there is a losing move, save it
-                if (pos.isWinningMove(x, y, false))
-                    loosingMove = Move(x, y);
-            }
-        }
-        // if no winning move are found, we should block loosing move
-        if (loosingMove.first != -1)
-            return loosingMove;
+    // start chronometer, the budgets of the turn depend on the stones left to play, a ponder search started them already
+    if (!m_time.isPondering())
+        m_time.startTurn(pos.getNbMoves());
+
+    // no search is running anymore, the tables can follow a memory limit changed during the last ponder search
+    if (m_resizePending.exchange(false, std::memory_order_acquire))
+        resizeTables();
+
+    // the transposition table is kept from the previous turns
+    m_tt.newSearch();
+
+    // the root moves are the candidates, from the center to the borders before the first iteration sorts them
+    std::vector<RootMove> rootMoves;
+    for (int i = 0; i < pos.getNbCandidates(); i++)
+        rootMoves.push_back({ pos.getCandidate(i), INT_MIN });
+    if (rootMoves.empty())
+        return Move(0, 0);
+    std::sort(rootMoves.begin(), rootMoves.end(), [this](const RootMove &a, const RootMove &b) {
+        return centerDistance(a.move) < centerDistance(b.move) || (centerDistance(a.move) == centerDistance(b.move) && a.move < b.move);
+    });
+
+    // if we have a winning move, play it
+    bool isMyTurn = pos.isMyTurn();
+    const Bitboard &wins = pos.getThreatCells(isMyTurn, ThreatType::five);
+    if (wins.any())
+        return pos.getCell(wins.first());
+
+    // if no winning move are found, we should block loosing move
+    const Bitboard &losses = pos.getThreatCells(!isMyTurn, ThreatType::five);
+    if (losses.any())
+        return pos.getCell(losses.first());
+
+    // a victory by continuous fours is played at once, then a victory by continuous threats searched on a part of the turn
+    // they share the soft budget of the turn, the search must still have the time for a move, and stop at an abort
+    // so a ponder search answers the expected reply with them as well
+    Position threatPos(pos);
+    Move threatMove;
+    uint32_t threatTime = std::min(getRemainingTime(), m_time.getRemainingSoftTime());
+    if (m_vcf.solve(threatPos, VCF_MAX_DEPTH, threatTime / VCF_TIME_DIVISOR, threatMove, &m_time))
+        return threatMove;
+    if (m_vct.solve(threatPos, VCT_MAX_DEPTH, threatTime / VCT_TIME_DIVISOR, threatMove, &m_time))
+        return threatMove;
+
+    // a position with threes on board is worth a proof attempt, a lost position is still searched for the best defense
+    bool tactical = pos.getThreatCells(isMyTurn, ThreatType::openFour).any() || pos.getThreatCells(!isMyTurn, ThreatType::openFour).any();
+    if (m_mode == SolverMode::proof) {
+        m_proofResult = m_pn.solve(threatPos, INT_MAX, threatTime / 2, threatMove, &m_time);
+    } else if (tactical) {
+        m_proofResult = m_pn.solve(threatPos, PN_MAX_NODES, threatTime / PN_TIME_DIVISOR, threatMove, &m_time);
     }
-    // else, play the best move
-    int bestScore = INT_MIN;
-    Move bestMove = Move(0, 0);
-
-    for (const auto &move : m_moveOrder) {
-        int x = move.first;
-        int y = move.second;
-
-        // play only moves that are not too far away
-        if (isTooFar(pos, x, y))
-            continue;
-
-        // ignore moves that are not playable
-        if (pos.canPlay(x, y)) {
-            // play move in new board
-            Position nextPos(pos);
-            nextPos.play(x, y);
-
-            // calculate score
-            int score = minimax(nextPos, m_depthLimit, INT_MIN, INT_MAX, false);
-
-            // update best move
-            if (score > bestScore) {
-                bestScore = score;
-                bestMove = Move(x, y);
-            }
-        }
+    if (m_proofResult == PNResult::win)
+        return threatMove;
+
+    // against a three, only the moves making or blocking a four are searched
+    if (pos.getThreatCells(!isMyTurn, ThreatType::openFour).any()) {
+        rootMoves.erase(std::remove_if(rootMoves.begin(), rootMoves.end(),
+                            [&pos, isMyTurn](const RootMove &rootMove) {
+                                return pos.getThreat(rootMove.move.first, rootMove.move.second, isMyTurn) < ThreatType::four
+                                    && pos.getThreat(rootMove.move.first, rootMove.move.second, !isMyTurn) < ThreatType::four;
+                            }),
+            rootMoves.end());
+        // a single answer is played at once, a few ones need less time
+        if (rootMoves.size() == 1)
+            return rootMoves.front().move;
+        m_time.setForced();
     }
 
-    return bestMove;
+    // each thread plays and undoes its moves on its own copy of the position
+    std::vector<SearchThread> threads;
+    threads.reserve(m_nbThreads);
+    for (uint32_t i = 0; i < m_nbThreads; i++)
+        threads.emplace_back(static_cast<int>(i), pos, rootMoves);
+    m_stop = false;
+
+    std::vector<std::thread> helpers;
+    for (uint32_t i = 1; i < m_nbThreads; i++)
+        helpers.emplace_back(&Solver::iterativeDeepening, this, std::ref(threads[i]));
+    iterativeDeepening(threads[0]);
+    for (auto &helper : helpers)
+        helper.join();
+
+    // keep the move of the deepest complete iteration, the main thread first
+    const SearchThread *best = &threads[0];
+    for (const auto &thread : threads) {
+        if (thread.completedDepth > best->completedDepth)
+            best = &thread;
+    }
+    return best->bestMove;
 }
 }
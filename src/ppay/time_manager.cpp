@@ -0,0 +1,108 @@
+#include "ppay/time_manager.hpp"
+
+namespace gmk::ppay {
+
+TimeManager::TimeManager(std::uint32_t turnTime)
+    : m_turnTime(turnTime)
+    , m_matchTime(0)
+    , m_timeLeft(0)
+    , m_pondering(false)
+    , m_aborted(false)
+    , m_nbMoves(0)
+    , m_softTime(0)
+    , m_hardTime(0)
+    , m_timePercent(100)
+    , m_instability(0)
+    , m_scores { 0, 0 }
+    , m_hasScores { false, false }
+    , m_startTurn(0)
+{
+    startTurn(0);
+}
+
+void TimeManager::startTurn(int nbMoves)
+{
+    m_nbMoves = nbMoves;
+    m_timePercent = 100;
+    m_instability = 0;
+    m_hasScores[0] = m_hasScores[1] = false;
+    restartTurn();
+}
+
+void TimeManager::restartTurn()
+{
+    m_startTurn = now();
+    computeBudgets();
+}
+
+void TimeManager::computeBudgets()
+{
+    m_hardTime = getTurnTime();
+    m_softTime = m_hardTime;
+
+    // the match time left is shared between our moves expected to be left, a reserve is never used
+    if (m_matchTime > 0) {
+        std::uint32_t timeLeft = m_timeLeft;
+        std::uint32_t usable = timeLeft > MATCH_TIME_RESERVE ? timeLeft - MATCH_TIME_RESERVE : 0;
+        std::uint32_t movesLeft = std::max(MIN_MOVES_LEFT, (EXPECTED_GAME_MOVES - m_nbMoves) / 2);
+
+        m_softTime = std::min(m_softTime, usable / movesLeft);
+        m_hardTime = std::min({ m_hardTime, usable / MAX_MATCH_TIME_DIVISOR, m_softTime * HARD_TIME_RATIO });
+    }
+}
+
+void TimeManager::setForced()
+{
+    m_timePercent = m_timePercent * FORCED_TIME_PERCENT / 100;
+}
+
+bool TimeManager::shouldStop(int depth, bool bestMoveChanged, int score)
+{
+    // an unstable best move asks for more time, it is forgotten over a few iterations
+    m_instability = m_instability / 2 + (bestMoveChanged ? 100 : 0);
+
+    // the scores alternate between odd and even depths, a score is compared to the last one of the same parity
+    int parity = depth % 2;
+    bool critical = m_hasScores[parity] && score < m_scores[parity] - CRITICAL_SCORE_DROP;
+    m_scores[parity] = score;
+    m_hasScores[parity] = true;
+
+    // with a turn limit only, the time not used is lost
+    if (m_matchTime == 0)
+        return false;
+
+    long long percent = static_cast<long long>(m_timePercent) * (100 + m_instability * INSTABILITY_TIME_PERCENT / 100) / 100;
+    if (critical)
+        percent = percent * CRITICAL_TIME_PERCENT / 100;
+    long long softTime = std::min(static_cast<long long>(m_hardTime), m_softTime * percent / 100);
+    return elapsed() >= softTime * ITERATION_TIME_PERCENT / 100;
+}
+
+std::uint32_t TimeManager::getRemainingTime() const
+{
+    // the budgets and the clock are only read once ponderHit() has set them
+    if (m_aborted.load(std::memory_order_relaxed))
+        return 0;
+    if (isPondering())
+        return getTurnTime();
+
+    std::uint32_t spent = elapsed();
+    return spent >= m_hardTime ? 0 : m_hardTime - spent;
+}
+
+std::uint32_t TimeManager::getRemainingSoftTime() const
+{
+    if (m_aborted.load(std::memory_order_relaxed))
+        return 0;
+    if (isPondering())
+        return getTurnTime();
+
+    std::uint32_t spent = elapsed();
+    return spent >= m_softTime ? 0 : m_softTime - spent;
+}
+
+std::uint32_t TimeManager::elapsed() const
+{
+    return static_cast<std::uint32_t>(now() - m_startTurn);
+}
+}
@@ -0,0 +1,94 @@
+#include "ppay/vcf.hpp"
+
+namespace gmk::ppay {
+
+// the clock is read once every VCF_TIME_CHECK nodes
+#define VCF_TIME_CHECK 1024
+
+VCFSolver::VCFSolver()
+    : m_table(1 << VCF_TABLE_BITS, VCFEntry { 0, 0 })
+    , m_nodeCount(0)
+    , m_stop(false)
+{
+}
+
+bool VCFSolver::solve(Position &pos, int maxDepth, std::uint32_t maxTime, Move &move, const TimeManager *time)
+{
+    m_nodeCount = 0;
+    m_stop = false;
+    m_deadline = Deadline(maxTime, time);
+    return search(pos, maxDepth, move);
+}
+
+bool VCFSolver::search(Position &pos, int depth, Move &move)
+{
+    bool attacker = pos.isMyTurn();
+
+    if (++m_nodeCount >= VCF_MAX_NODES || (m_nodeCount % VCF_TIME_CHECK == 0 && m_deadline.isPassed()))
+        m_stop = true;
+
+    // the sequence ends with a five
+    const Bitboard &fives = pos.getThreatCells(attacker, ThreatType::five);
+    if (fives.any()) {
+        move = pos.getCell(fives.first());
+        return true;
+    }
+    if (depth == 0 || m_stop)
+        return false;
+
+    // a four of the defender must be blocked, and the block must be a four as well to keep the initiative
+    const Bitboard &blocks = pos.getThreatCells(!attacker, ThreatType::five);
+    int nbBlocks = blocks.count();
+    if (nbBlocks >= 2)
+        return false;
+
+    std::uint64_t hash = pos.zobristHash();
+    VCFEntry &entry = m_table[hash & ((1 << VCF_TABLE_BITS) - 1)];
+    if (entry.key == hash && entry.depth >= depth)
+        return false;
+
+    Bitboard fours = pos.getThreatCells(attacker, ThreatType::four) | pos.getThreatCells(attacker, ThreatType::openFour);
+    if (nbBlocks)
+        fours &= blocks;
+
+    while (fours.any()) {
+        int index = fours.first();
+        fours.reset(index);
+        Move four = pos.getCell(index);
+
+        // an open four cannot be blocked
+        if (pos.getThreat(four.first, four.second, attacker) == ThreatType::openFour) {
+            move = four;
+            return true;
+        }
+
+        pos.makeMove(four.first, four.second);
+        const Bitboard &threats = pos.getThreatCells(attacker, ThreatType::five);
+
+        // two fours at once cannot be blocked either
+        if (threats.count() >= 2) {
+            pos.unmakeMove();
+            move = four;
+            return true;
+        }
+
+        // the defender has a single reply
+        Move reply = pos.getCell(threats.first());
+        pos.makeMove(reply.first, reply.second);
+        Move next;
+        bool win = search(pos, depth - 1, next);
+        pos.unmakeMove();
+        pos.unmakeMove();
+
+        if (win) {
+            move = four;
+            return true;
+        }
+    }
+
+    // an aborted search proves nothing
+    if (!m_stop)
+        entry = { hash, depth };
+    return false;
+}
+}
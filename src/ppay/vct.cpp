@@ -0,0 +1,144 @@
+#include <algorithm>
+
+#include "ppay/vct.hpp"
+
+namespace gmk::ppay {
+
+// the clock is read once every VCT_TIME_CHECK nodes
+#define VCT_TIME_CHECK 1024
+
+VCTSolver::VCTSolver()
+    : m_table(1 << VCT_TABLE_BITS)
+    , m_nodeCount(0)
+    , m_stop(false)
+{
+}
+
+bool VCTSolver::solve(Position &pos, int maxDepth, std::uint32_t maxTime, Move &move, const TimeManager *time)
+{
+    // the results depend on the attacker, the table is only kept during one search
+    std::fill(m_table.begin(), m_table.end(), VCTEntry { 0, 0, VCTResult::unknown, Move(-1, -1) });
+    m_nodeCount = 0;
+    m_stop = false;
+    m_deadline = Deadline(maxTime, time);
+
+    // the shallow searches fill the table for the deeper ones, and find the shortest victories first
+    for (int depth = 1; depth <= maxDepth && !m_stop; depth++) {
+        // a victory found before the time is up is still sound
+        if (attack(pos, depth, move))
+            return true;
+    }
+    return false;
+}
+
+bool VCTSolver::attack(Position &pos, int depth, Move &move)
+{
+    bool attacker = pos.isMyTurn();
+
+    if (++m_nodeCount % VCT_TIME_CHECK == 0 && m_deadline.isPassed())
+        m_stop = true;
+    if (m_stop)
+        return false;
+
+    const Bitboard &fives = pos.getThreatCells(attacker, ThreatType::five);
+    if (fives.any()) {
+        move = pos.getCell(fives.first());
+        return true;
+    }
+
+    // a four of the defender must be blocked, the threats already on board may still win after it
+    const Bitboard &blocks = pos.getThreatCells(!attacker, ThreatType::five);
+    int nbBlocks = blocks.count();
+    if (nbBlocks >= 2)
+        return false;
+    if (nbBlocks == 1) {
+        move = pos.getCell(blocks.first());
+        return playAttack(pos, move, depth);
+    }
+    if (depth == 0)
+        return false;
+
+    std::uint64_t hash = pos.zobristHash();
+    VCTEntry &entry = m_table[hash & ((1 << VCT_TABLE_BITS) - 1)];
+    if (entry.key == hash) {
+        if (entry.result == VCTResult::proven && entry.depth <= depth) {
+            move = entry.move;
+            return true;
+        }
+        if (entry.result == VCTResult::disproven && entry.depth >= depth)
+            return false;
+    }
+
+    // an open four wins, a four or a three is a threat, but a three is too slow against a three of the defender
+    if (pos.getThreatCells(attacker, ThreatType::openFour).any()) {
+        move = pos.getCell(pos.getThreatCells(attacker, ThreatType::openFour).first());
+        return true;
+    }
+    Bitboard threats = pos.getThreatCells(attacker, ThreatType::four);
+    if (!pos.getThreatCells(!attacker, ThreatType::openFour).any())
+        threats |= pos.getThreatCells(attacker, ThreatType::openThree) | pos.getThreatCells(attacker, ThreatType::brokenThree);
+
+    bool win = false;
+    while (threats.any() && !win) {
+        int index = threats.first();
+        threats.reset(index);
+        move = pos.getCell(index);
+        win = playAttack(pos, move, depth - 1);
+    }
+
+    // an unfinished search proves nothing
+    if (win || !m_stop)
+        entry = { hash, depth, win ? VCTResult::proven : VCTResult::disproven, move };
+    return win;
+}
+
+bool VCTSolver::playAttack(Position &pos, const Move &move, int depth)
+{
+    pos.makeMove(move.first, move.second);
+    bool win = defend(pos, depth);
+    pos.unmakeMove();
+    return win;
+}
+
+bool VCTSolver::defend(Position &pos, int depth)
+{
+    bool defender = pos.isMyTurn();
+
+    // the defender wins first
+    if (pos.getThreatCells(defender, ThreatType::five).any())
+        return false;
+
+    const Bitboard &fives = pos.getThreatCells(!defender, ThreatType::five);
+    int nbFives = fives.count();
+    if (nbFives >= 2)
+        return true;
+
+    Bitboard defenses;
+    if (nbFives == 1) {
+        // a four has a single reply
+        defenses = fives;
+    } else {
+        // a three is blocked on a cell where the attacker makes a four, unless the defender makes its own four first,
+        // an open four of the defender is faster than the three
+        const Bitboard &openFours = pos.getThreatCells(!defender, ThreatType::openFour);
+        if (!openFours.any() || pos.getThreatCells(defender, ThreatType::openFour).any())
+            return false;
+        defenses = openFours | pos.getThreatCells(!defender, ThreatType::four) | pos.getThreatCells(defender, ThreatType::four);
+    }
+
+    while (defenses.any()) {
+        int index = defenses.first();
+        defenses.reset(index);
+        Move defense = pos.getCell(index);
+
+        pos.makeMove(defense.first, defense.second);
+        Move next;
+        bool win = attack(pos, depth, next);
+        pos.unmakeMove();
+
+        if (!win || m_stop)
+            return false;
+    }
+    return true;
+}
+}
@@ -0,0 +1,79 @@
+/**
+ * @file fixtures.hpp
+ * @brief Positions shared by the tests of several solvers
+ */
+
+#ifndef TESTS_FIXTURES_HPP
+#define TESTS_FIXTURES_HPP
+
+#include "ppay/position.hpp"
+
+namespace gmk::ppay {
+
+/**
+ * Opening of three stones, ours between two of the opponent, we are to move.
+ */
+inline Position openingPosition()
+{
+    Position pos(15, 15);
+
+    pos.play(7, 7, false);
+    pos.play(8, 8, true);
+    pos.play(6, 8, false);
+    pos.setIsMyTurn(true);
+    return pos;
+}
+
+/**
+ * A four of ours blocked on the left, the only five is on (9, 7), we are to move.
+ */
+inline Position blockedFourPosition()
+{
+    Position pos(15, 15);
+
+    pos.play(4, 7, false);
+    for (int x = 5; x < 9; x++) {
+        pos.play(x, 7, true);
+        pos.play(x, 3, false);
+    }
+    pos.setIsMyTurn(true);
+    return pos;
+}
+
+/**
+ * Two open twos of ours crossing on an empty cell, we are to move: the cell makes two open threes.
+ */
+inline Position crossingTwosPosition()
+{
+    Position pos(15, 15);
+
+    pos.play(7, 7, true);
+    pos.play(8, 7, true);
+    pos.play(9, 4, true);
+    pos.play(9, 5, true);
+    pos.play(0, 0, false);
+    pos.play(14, 14, false);
+    pos.setIsMyTurn(true);
+    return pos;
+}
+
+/**
+ * A blocked three of ours makes a four on (7, 5), its stone turns a split two into an open three, then into an open four,
+ * we are to move.
+ */
+inline Position fourThenOpenFourPosition()
+{
+    Position pos(15, 15);
+
+    for (int y = 6; y < 9; y++)
+        pos.play(7, y, true);
+    pos.play(4, 5, true);
+    pos.play(5, 5, true);
+    pos.play(7, 9, false);
+    pos.play(12, 12, false);
+    pos.setIsMyTurn(true);
+    return pos;
+}
+}
+
+#endif /* TESTS_FIXTURES_HPP */
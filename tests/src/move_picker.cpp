@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "ppay/move_picker.hpp"
+
+#include "fixtures.hpp"
+
+namespace gmk::ppay {
+
+static const Move noKillers[NB_KILLERS] = { Move(-1, -1), Move(-1, -1) };
+static const int noHistory[MAX_BOARD_SIZE * MAX_BOARD_SIZE] = {};
+static QuietMove quiets[MAX_BOARD_SIZE * MAX_BOARD_SIZE];
+
+/**
+ * Threats of both players on the cell of a move, the first key of the quiet moves.
+ */
+static int threatSum(const Position &pos, const Move &move)
+{
+    return static_cast<int>(pos.getThreat(move.first, move.second, true)) + static_cast<int>(pos.getThreat(move.first, move.second, false));
+}
+
+TEST(MovePicker, AllCandidatesOnce)
+{
+    // the opponent is to move, with its two stones
+    Position pos = openingPosition();
+    pos.setIsMyTurn(false);
+
+    // the tt move comes first, then the own three cells before the quiet moves
+    MovePicker picker(pos, Move(5, 5), noKillers, noHistory, quiets);
+    std::set<Move> moves;
+    Move move;
+    ASSERT_TRUE(picker.next(move));
+    EXPECT_EQ(move, Move(5, 5));
+    moves.insert(move);
+    while (picker.next(move)) {
+        EXPECT_TRUE(moves.insert(move).second);
+        EXPECT_TRUE(pos.canPlay(move.first, move.second));
+    }
+    EXPECT_EQ(static_cast<int>(moves.size()), pos.getNbCandidates());
+}
+
+TEST(MovePicker, ForcedBlock)
+{
+    Position pos(15, 15);
+
+    // the opponent four is blocked on the left, the only move is on the right
+    pos.play(4, 7, true);
+    for (int x = 5; x < 9; x++)
+        pos.play(x, 7, false);
+    pos.play(2, 2, true);
+    pos.play(3, 12, true);
+    pos.setIsMyTurn(true);
+
+    // the killer does not stop the five, it is not given
+    const Move killers[NB_KILLERS] = { Move(6, 6), Move(-1, -1) };
+    MovePicker picker(pos, Move(-1, -1), killers, noHistory, quiets);
+    Move move;
+    ASSERT_TRUE(picker.next(move));
+    EXPECT_EQ(move, Move(9, 7));
+    EXPECT_FALSE(picker.next(move));
+}
+
+TEST(MovePicker, WinAfterTTMove)
+{
+    Position pos(15, 15);
+
+    // our four is blocked on the left, the five is on the right, the opponent has no threat
+    pos.play(4, 7, false);
+    for (int x = 5; x < 9; x++)
+        pos.play(x, 7, true);
+    pos.play(2, 2, false);
+    pos.play(3, 12, false);
+    pos.setIsMyTurn(true);
+
+    // a tt move which is not the win is given first, the five right after it
+    MovePicker picker(pos, Move(6, 8), noKillers, noHistory, quiets);
+    Move move;
+    ASSERT_TRUE(picker.next(move));
+    EXPECT_EQ(move, Move(6, 8));
+    ASSERT_TRUE(picker.next(move));
+    EXPECT_EQ(move, Move(9, 7));
+}
+
+TEST(MovePicker, KillersAndHistory)
+{
+    // the opponent is to move, with its two stones
+    Position pos = openingPosition();
+    pos.setIsMyTurn(false);
+
+    // the last move given without killers nor history, a quiet move coming after others as quiet as it
+    Move last;
+    MovePicker picker(pos, Move(-1, -1), noKillers, noHistory, quiets);
+    while (picker.next(last))
+        ;
+
+    // as a killer, it comes before all the quiet moves
+    const Move killers[NB_KILLERS] = { last, Move(-1, -1) };
+    MovePicker killerPicker(pos, Move(-1, -1), killers, noHistory, quiets);
+    Move move;
+    bool killerGiven = false;
+    while (killerPicker.next(move)) {
+        if (move == last) {
+            EXPECT_FALSE(killerPicker.isQuiet());
+            killerGiven = true;
+        }
+        if (killerPicker.isQuiet()) {
+            EXPECT_TRUE(killerGiven);
+        }
+    }
+    EXPECT_TRUE(killerGiven);
+
+    // with a history score, it comes before the quiet moves with the same threats
+    int history[MAX_BOARD_SIZE * MAX_BOARD_SIZE] = {};
+    history[last.first + last.second * MAX_BOARD_SIZE] = 100;
+    MovePicker historyPicker(pos, Move(-1, -1), noKillers, history, quiets);
+    while (historyPicker.next(move) && move != last) {
+        if (historyPicker.isQuiet()) {
+            EXPECT_GT(threatSum(pos, move), threatSum(pos, last));
+        }
+    }
+    EXPECT_EQ(move, last);
+    EXPECT_TRUE(historyPicker.isQuiet());
+}
+}
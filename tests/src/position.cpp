@@ -6,9 +6,12 @@ namespace gmk::ppay {
 
 void randomFill(Position &pos)
 {
-    for (int i = 0; i < pos.getNbCells(); i++)
-        if (pos.canPlay(i % pos.getWidth(), i / pos.getWidth()))
-            pos.play(rand() % pos.getWidth(), rand() % pos.getHeight());
+    for (int i = 0; i < pos.getNbCells(); i++) {
+        int x = rand() % pos.getWidth();
+        int y = rand() % pos.getHeight();
+        if (pos.canPlay(x, y))
+            pos.play(x, y);
+    }
 }
 
 TEST(Position, EmptyBoard)
@@ -483,4 +486,420 @@ TEST(Position, WinningMoveAntiDiagonal)
     EXPECT_EQ(countWinningMoves(pos), 2);
     pos.play(3, 6);
 }
-}
\ No newline at end of file
+
+TEST(Position, WinningMoveRowBorder)
+{
+    Position pos(10, 10);
+
+    // a row must not continue on the next one
+    pos.play(6, 0, true);
+    pos.play(7, 0, true);
+    pos.play(8, 0, true);
+    pos.play(9, 0, true);
+    pos.play(0, 1, true);
+
+    EXPECT_TRUE(pos.isWinningMove(5, 0, true));
+    EXPECT_FALSE(pos.isWinningMove(1, 1, true));
+    EXPECT_FALSE(pos.isWinningMove(0, 2, true));
+}
+
+TEST(Position, HeuristicFlip)
+{
+    srand(time(nullptr));
+
+    Position pos(20, 20);
+    for (int i = 0; i < 40; i++) {
+        int x = rand() % pos.getWidth();
+        int y = rand() % pos.getHeight();
+        if (pos.canPlay(x, y))
+            pos.play(x, y);
+    }
+
+    EXPECT_EQ(pos.heuristic(), pos.verticalFlip().heuristic());
+    EXPECT_EQ(pos.heuristic(), pos.horizontalFlip().heuristic());
+    EXPECT_EQ(pos.heuristic(), pos.diagonalFlip().heuristic());
+    EXPECT_EQ(pos.heuristic(), pos.antiDiagonalFlip().heuristic());
+}
+
+TEST(Position, MakeUnmakeMove)
+{
+    srand(time(nullptr));
+
+    Position pos(20, 20);
+    pos.play(10, 10);
+    Position initial(pos);
+
+    int nbMoves = 0;
+    for (int i = 0; i < 50; i++) {
+        int x = rand() % pos.getWidth();
+        int y = rand() % pos.getHeight();
+        if (pos.canPlay(x, y)) {
+            pos.makeMove(x, y);
+            EXPECT_FALSE(pos.canPlay(x, y));
+            nbMoves++;
+        }
+    }
+    EXPECT_NE(pos, initial);
+
+    while (nbMoves--)
+        pos.unmakeMove();
+
+    EXPECT_EQ(pos, initial);
+    EXPECT_EQ(pos.getMinX(), 10);
+    EXPECT_EQ(pos.getMinY(), 10);
+    EXPECT_EQ(pos.getMaxX(), 10);
+    EXPECT_EQ(pos.getMaxY(), 10);
+}
+
+TEST(Position, ClearBoundingBox)
+{
+    Position pos(20, 20);
+
+    pos.play(5, 5);
+    pos.play(12, 14);
+    EXPECT_EQ(pos.getMaxX(), 12);
+    EXPECT_EQ(pos.getMaxY(), 14);
+
+    pos.clear(12, 14);
+    EXPECT_EQ(pos.getMinX(), 5);
+    EXPECT_EQ(pos.getMinY(), 5);
+    EXPECT_EQ(pos.getMaxX(), 5);
+    EXPECT_EQ(pos.getMaxY(), 5);
+}
+
+TEST(Position, ZobristHash)
+{
+    Position pos1(20, 20);
+    Position pos2(20, 20);
+
+    // same stones played in another order
+    pos1.play(3, 4);
+    pos1.play(10, 10);
+    pos1.play(5, 6);
+    pos1.play(11, 2);
+
+    pos2.play(5, 6);
+    pos2.play(11, 2);
+    pos2.play(3, 4);
+    pos2.play(10, 10);
+
+    EXPECT_EQ(pos1.zobristHash(), pos2.zobristHash());
+
+    // side to move is part of the hash
+    pos2.setIsMyTurn(false);
+    EXPECT_NE(pos1.zobristHash(), pos2.zobristHash());
+    pos2.setIsMyTurn(true);
+
+    pos1.makeMove(0, 0);
+    EXPECT_NE(pos1.zobristHash(), pos2.zobristHash());
+    pos1.unmakeMove();
+    EXPECT_EQ(pos1.zobristHash(), pos2.zobristHash());
+
+    pos1.play(0, 0);
+    pos1.clear(0, 0);
+    EXPECT_EQ(pos1.zobristHash(), pos2.zobristHash());
+}
+
+TEST(Position, HashSymmetricMoves)
+{
+    Position pos(15, 15);
+    Position sym(15, 15);
+
+    // quarter turn of the same moves
+    pos.play(3, 4);
+    pos.play(7, 7);
+    pos.play(2, 9);
+    sym.play(10, 3);
+    sym.play(7, 7);
+    sym.play(5, 2);
+
+    EXPECT_EQ(pos.hash(), sym.hash());
+    EXPECT_NE(pos.zobristHash(), sym.zobristHash());
+
+    // the other player to move is another position
+    sym.setIsMyTurn(!sym.isMyTurn());
+    EXPECT_NE(pos.hash(), sym.hash());
+}
+
+TEST(Position, IncrementalHeuristic)
+{
+    srand(time(nullptr));
+
+    Position pos(20, 20);
+    EXPECT_EQ(pos.heuristic(), 0);
+
+    for (int i = 0; i < 200; i++) {
+        int x = rand() % pos.getWidth();
+        int y = rand() % pos.getHeight();
+        if (pos.canPlay(x, y))
+            pos.play(x, y);
+        EXPECT_EQ(pos.heuristic(), pos.computeHeuristic());
+    }
+
+    for (int y = 0; y < pos.getHeight(); y++)
+        for (int x = 0; x < pos.getWidth(); x++)
+            if (!pos.canPlay(x, y) && rand() % 2) {
+                pos.clear(x, y);
+                EXPECT_EQ(pos.heuristic(), pos.computeHeuristic());
+            }
+}
+
+TEST(Position, CanonicalCell)
+{
+    srand(time(nullptr));
+
+    Position pos(15, 15);
+    randomFill(pos);
+    Position sym = pos.antiDiagonalFlip();
+
+    for (int y = 0; y < pos.getHeight(); y++) {
+        for (int x = 0; x < pos.getWidth(); x++) {
+            std::pair<int, int> move = pos.fromCanonicalCell(pos.canonicalCell(x, y));
+            EXPECT_EQ(move, std::make_pair(x, y));
+
+            // the same canonical cell is the symmetric move in the symmetric position
+            move = sym.fromCanonicalCell(pos.canonicalCell(x, y));
+            EXPECT_EQ(move, std::make_pair(pos.getHeight() - y - 1, pos.getWidth() - x - 1));
+        }
+    }
+}
+
+// candidates computed from scratch
+static int countCandidates(const Position &pos)
+{
+    int count = 0;
+    for (int y = 0; y < pos.getHeight(); y++) {
+        for (int x = 0; x < pos.getWidth(); x++) {
+            bool near = false;
+            for (int j = std::max(0, y - CANDIDATE_RADIUS); j <= std::min(pos.getHeight() - 1, y + CANDIDATE_RADIUS); j++)
+                for (int i = std::max(0, x - CANDIDATE_RADIUS); i <= std::min(pos.getWidth() - 1, x + CANDIDATE_RADIUS); i++)
+                    near |= !pos.canPlay(i, j);
+            count += near && pos.canPlay(x, y);
+        }
+    }
+    return count;
+}
+
+TEST(Position, Candidates)
+{
+    srand(time(nullptr));
+
+    Position pos(20, 15);
+    EXPECT_EQ(pos.getNbCandidates(), 0);
+
+    pos.play(0, 0);
+    EXPECT_EQ(pos.getNbCandidates(), 8);
+
+    int nbMoves = 0;
+    for (int i = 0; i < 100; i++) {
+        int x = rand() % pos.getWidth();
+        int y = rand() % pos.getHeight();
+        if (pos.canPlay(x, y)) {
+            pos.makeMove(x, y);
+            nbMoves++;
+        }
+    }
+    EXPECT_EQ(pos.getNbCandidates(), countCandidates(pos));
+    EXPECT_EQ(pos.getCandidates().count(), pos.getNbCandidates());
+    for (int i = 0; i < pos.getNbCandidates(); i++) {
+        std::pair<int, int> move = pos.getCandidate(i);
+        EXPECT_TRUE(pos.canPlay(move.first, move.second));
+    }
+
+    while (nbMoves--)
+        pos.unmakeMove();
+    EXPECT_EQ(pos.getNbCandidates(), 8);
+
+    pos.clear(0, 0);
+    EXPECT_EQ(pos.getNbCandidates(), 0);
+}
+
+// five in a row through a cell, checked on the board
+static bool makesFive(const Position &pos, int x, int y, int state)
+{
+    static const int directions[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 } };
+
+    for (const auto &direction : directions) {
+        int length = 1;
+        for (int sign = -1; sign <= 1; sign += 2) {
+            int i = x + sign * direction[0];
+            int j = y + sign * direction[1];
+            while (i >= 0 && j >= 0 && i < pos.getWidth() && j < pos.getHeight() && pos.getState(i, j) == state) {
+                length++;
+                i += sign * direction[0];
+                j += sign * direction[1];
+            }
+        }
+        if (length >= 5)
+            return true;
+    }
+    return false;
+}
+
+TEST(Position, WinningMoveRuns)
+{
+    srand(time(nullptr));
+
+    for (int game = 0; game < 20; game++) {
+        Position pos(15, 12);
+        int nbMoves = 0;
+
+        // dense random games, with moves undone and stones taken back
+        for (int i = 0; i < 300; i++) {
+            int x = rand() % pos.getWidth();
+            int y = rand() % pos.getHeight();
+            if (pos.canPlay(x, y)) {
+                pos.makeMove(x, y);
+                nbMoves++;
+            } else if (rand() % 4 == 0 && nbMoves > 0) {
+                pos.unmakeMove();
+                nbMoves--;
+            }
+        }
+        for (int i = 0; i < 10; i++) {
+            int x = rand() % pos.getWidth();
+            int y = rand() % pos.getHeight();
+            if (!pos.canPlay(x, y))
+                pos.clear(x, y);
+        }
+
+        for (int y = 0; y < pos.getHeight(); y++) {
+            for (int x = 0; x < pos.getWidth(); x++) {
+                if (!pos.canPlay(x, y))
+                    continue;
+                EXPECT_EQ(pos.isWinningMove(x, y, true), makesFive(pos, x, y, 1));
+                EXPECT_EQ(pos.isWinningMove(x, y, false), makesFive(pos, x, y, 2));
+            }
+        }
+    }
+}
+
+TEST(Position, Threats)
+{
+    Position pos(15, 15);
+
+    // me: open two, the opponent blocks nothing
+    pos.play(5, 7, true);
+    pos.play(0, 0, false);
+    pos.play(6, 7, true);
+    pos.play(0, 14, false);
+    EXPECT_EQ(pos.getThreat(7, 7, true), ThreatType::openThree);
+    EXPECT_EQ(pos.getThreat(4, 7, true), ThreatType::openThree);
+    EXPECT_EQ(pos.getThreat(8, 7, true), ThreatType::brokenThree);
+    EXPECT_EQ(pos.getThreat(7, 7, false), ThreatType::none);
+
+    // me: open three, both ends make an open four
+    pos.play(7, 7, true);
+    EXPECT_EQ(pos.getThreat(4, 7, true), ThreatType::openFour);
+    EXPECT_EQ(pos.getThreat(8, 7, true), ThreatType::openFour);
+    EXPECT_EQ(pos.getThreat(3, 7, true), ThreatType::four);
+    EXPECT_EQ(pos.getThreatCells(true, ThreatType::openFour).count(), 2);
+
+    // opponent blocks one end, only fours are left
+    pos.play(8, 7, false);
+    EXPECT_EQ(pos.getThreat(4, 7, true), ThreatType::four);
+    EXPECT_EQ(pos.getThreat(3, 7, true), ThreatType::four);
+    EXPECT_FALSE(pos.getThreatCells(true, ThreatType::openFour).any());
+
+    pos.play(4, 7, true);
+    EXPECT_EQ(pos.getThreat(3, 7, true), ThreatType::five);
+    EXPECT_EQ(pos.getThreatCells(true, ThreatType::five).count(), 1);
+
+    pos.clear(8, 7);
+    EXPECT_EQ(pos.getThreatCells(true, ThreatType::five).count(), 2);
+}
+
+TEST(Position, IncrementalThreats)
+{
+    srand(time(nullptr));
+
+    Position pos(17, 13);
+    int nbMoves = 0;
+    for (int i = 0; i < 200; i++) {
+        int x = rand() % pos.getWidth();
+        int y = rand() % pos.getHeight();
+        if (pos.canPlay(x, y)) {
+            pos.makeMove(x, y);
+            nbMoves++;
+        } else if (rand() % 3 == 0 && nbMoves > 0) {
+            pos.unmakeMove();
+            nbMoves--;
+        }
+    }
+
+    // same stones played at once
+    Position fresh(17, 13);
+    for (int y = 0; y < pos.getHeight(); y++)
+        for (int x = 0; x < pos.getWidth(); x++)
+            if (pos.getState(x, y))
+                fresh.play(x, y, pos.getState(x, y) == 1);
+
+    for (int y = 0; y < pos.getHeight(); y++) {
+        for (int x = 0; x < pos.getWidth(); x++) {
+            EXPECT_EQ(pos.getThreat(x, y, true), fresh.getThreat(x, y, true));
+            EXPECT_EQ(pos.getThreat(x, y, false), fresh.getThreat(x, y, false));
+        }
+    }
+    for (int type = 1; type < NB_THREAT_TYPES; type++) {
+        EXPECT_EQ(pos.getThreatCells(true, static_cast<ThreatType>(type)), fresh.getThreatCells(true, static_cast<ThreatType>(type)));
+        EXPECT_EQ(pos.getThreatCells(false, static_cast<ThreatType>(type)), fresh.getThreatCells(false, static_cast<ThreatType>(type)));
+    }
+}
+
+/**
+ * Threat of a player on an empty cell, read cell by cell from the stones of the board in the four directions.
+ */
+static ThreatType recountThreat(const Position &pos, int x, int y, int player)
+{
+    static const int directions[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+
+    ThreatType best = ThreatType::none;
+    for (const auto &direction : directions) {
+        int stones = 0;
+        int blocked = 0;
+        for (int k = -4; k <= 4; k++) {
+            int cx = x + k * direction[0];
+            int cy = y + k * direction[1];
+            if (cx < 0 || cx >= pos.getWidth() || cy < 0 || cy >= pos.getHeight())
+                blocked |= 1 << (k + 4);
+            else if (pos.getState(cx, cy) == player)
+                stones |= 1 << (k + 4);
+            else if (pos.getState(cx, cy))
+                blocked |= 1 << (k + 4);
+        }
+        best = std::max(best, threatPatterns.get(stones, blocked));
+    }
+    return best;
+}
+
+TEST(Position, IncrementalThreatsBigBoards)
+{
+    srand(time(nullptr));
+
+    // the lines of the biggest boards are read as far as the lines of the smallest ones
+    for (auto [width, height] : { std::pair(32, 32), std::pair(20, 32), std::pair(30, 30) }) {
+        Position pos(width, height);
+        int nbMoves = 0;
+        for (int i = 0; i < 2000; i++) {
+            int x = rand() % width;
+            int y = rand() % height;
+            if (pos.canPlay(x, y)) {
+                pos.makeMove(x, y);
+                nbMoves++;
+            } else if (rand() % 3 == 0 && nbMoves > 0) {
+                pos.unmakeMove();
+                nbMoves--;
+            }
+        }
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                ThreatType mine = pos.getState(x, y) ? ThreatType::none : recountThreat(pos, x, y, 1);
+                ThreatType theirs = pos.getState(x, y) ? ThreatType::none : recountThreat(pos, x, y, 2);
+                EXPECT_EQ(pos.getThreat(x, y, true), mine) << x << "," << y;
+                EXPECT_EQ(pos.getThreat(x, y, false), theirs) << x << "," << y;
+            }
+        }
+    }
+}
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+
+#include "ppay/proof_number.hpp"
+
+#include "fixtures.hpp"
+
+namespace gmk::ppay {
+
+TEST(ProofNumber, Win)
+{
+    Position pos = crossingTwosPosition();
+    Position initial(pos);
+
+    PNSolver pn(1024 * 1024);
+    Move move;
+    EXPECT_EQ(pn.solve(pos, 1000000, 5000, move), PNResult::win);
+    EXPECT_EQ(pos, initial);
+
+    // the winning move is proven as well
+    pos.makeMove(move.first, move.second);
+    EXPECT_EQ(pn.solve(pos, 1000000, 5000, move), PNResult::loss);
+}
+
+TEST(ProofNumber, Unknown)
+{
+    Position pos(15, 15);
+    pos.play(7, 7, true);
+    pos.play(8, 8, false);
+
+    PNSolver pn(1024 * 1024);
+    Move move;
+    EXPECT_EQ(pn.solve(pos, 1000, 5000, move), PNResult::unknown);
+    EXPECT_LE(pn.getNodeCount(), 1000);
+}
+}
@@ -0,0 +1,345 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <thread>
+
+#include "ppay/solver.hpp"
+
+#include "fixtures.hpp"
+
+namespace gmk::ppay {
+
+/**
+ * Root moves of a search of the position, all its candidates.
+ */
+static std::vector<RootMove> candidateRootMoves(const Position &pos)
+{
+    std::vector<RootMove> rootMoves;
+    for (int i = 0; i < pos.getNbCandidates(); i++)
+        rootMoves.push_back({ pos.getCandidate(i), -SCORE_INFINITY });
+    return rootMoves;
+}
+
+TEST(Solver, WinningMove)
+{
+    Position pos = blockedFourPosition();
+
+    Solver solver(15, 15, 0, 200);
+    EXPECT_EQ(solver.findBestMove(pos), Move(9, 7));
+}
+
+TEST(Solver, ProofMode)
+{
+    Position pos(15, 15);
+
+    // two open threes of the opponent far apart, we cannot block both nor make a four
+    for (int x = 3; x < 6; x++)
+        pos.play(x, 3, false);
+    for (int y = 9; y < 12; y++)
+        pos.play(11, y, false);
+    pos.play(7, 7, true);
+    pos.play(0, 14, true);
+    pos.setIsMyTurn(true);
+
+    // the proof attempt runs first, the position is still searched for the best defense
+    Solver solver(15, 15, 0, 1000);
+    solver.setMode(SolverMode::proof);
+    Move move = solver.findBestMove(pos);
+    EXPECT_EQ(solver.getProofResult(), PNResult::loss);
+    EXPECT_TRUE(pos.canPlay(move.first, move.second));
+}
+
+TEST(Solver, MemoryLimit)
+{
+    // the transposition table and the proof-number table fit together in the manager limit
+    for (uint32_t maxMemory : { 1024u * 1024u, 70u * 1024u * 1024u }) {
+        EXPECT_LE(Solver::getTTMemory(maxMemory) + Solver::getPNMemory(maxMemory), maxMemory);
+        EXPECT_GT(Solver::getPNMemory(maxMemory), 0u);
+    }
+}
+
+TEST(Solver, MultiThreaded)
+{
+    Position pos = openingPosition();
+
+    for (uint32_t threads : { 1u, 4u }) {
+        Solver solver(15, 15, 0, 200, threads);
+        Move move = solver.findBestMove(pos);
+
+        // the threads left their results in the table, the reply to the move played among them
+        EXPECT_TRUE(pos.canPlay(move.first, move.second));
+        Position next(pos);
+        next.play(move.first, move.second);
+        EXPECT_NE(solver.getPonderMove(next), Move(-1, -1));
+    }
+}
+
+TEST(Solver, SharedTable)
+{
+    Position pos = openingPosition();
+
+    // a helper thread searching the position after the main thread reads its score from the shared table at once
+    Solver solver(15, 15, 0, 30000, 2);
+    SearchThread main(0, pos, candidateRootMoves(pos));
+    SearchThread helper(1, pos, candidateRootMoves(pos));
+    int score = solver.negamax(main, 4, 0, -SCORE_INFINITY, SCORE_INFINITY, true);
+    EXPECT_EQ(solver.negamax(helper, 4, 0, -SCORE_INFINITY, SCORE_INFINITY, true), score);
+    EXPECT_EQ(helper.nodeCount, 1);
+    EXPECT_GT(main.nodeCount, 1);
+
+    // the same search in another solver has nothing to read
+    Solver other(15, 15, 0, 30000, 2);
+    SearchThread otherHelper(1, pos, candidateRootMoves(pos));
+    EXPECT_EQ(other.negamax(otherHelper, 4, 0, -SCORE_INFINITY, SCORE_INFINITY, true), score);
+    EXPECT_EQ(otherHelper.nodeCount, main.nodeCount);
+}
+
+TEST(Solver, IterativeDeepening)
+{
+    Position pos = openingPosition();
+
+    // the iterations go deeper until the time is up, the best move of the last one leads the root moves
+    Solver solver(15, 15, 0, 300);
+    SearchThread thread(0, pos, candidateRootMoves(pos));
+    solver.iterativeDeepening(thread);
+    EXPECT_GT(thread.completedDepth, 1);
+    EXPECT_EQ(thread.bestMove, thread.rootMoves.front().move);
+    EXPECT_TRUE(pos.getCandidates().test(pos.getIndex(thread.bestMove.first, thread.bestMove.second)));
+    EXPECT_EQ(thread.pos, pos);
+}
+
+TEST(Solver, IterativeDeepeningWin)
+{
+    Position pos = fourThenOpenFourPosition();
+
+    // the four, its block and the open four: the deepening stops at the first iteration finding the win
+    Solver solver(15, 15, 0, 30000);
+    SearchThread thread(0, pos, candidateRootMoves(pos));
+    solver.iterativeDeepening(thread);
+    EXPECT_EQ(thread.bestMove, Move(7, 5));
+    EXPECT_GE(thread.completedDepth, 1);
+    EXPECT_LE(thread.completedDepth, 3);
+}
+
+TEST(Solver, TableKeptAcrossTurns)
+{
+    Position pos = openingPosition();
+
+    Position won = blockedFourPosition();
+
+    // the search of a turn stores the expected reply to its best move
+    Solver solver(15, 15, 0, 300);
+    Move move = solver.findBestMove(pos);
+    Position next(pos);
+    next.play(move.first, move.second, true);
+    Move reply = solver.getPonderMove(next);
+    EXPECT_NE(reply, Move(-1, -1));
+
+    // it is still known after the next turn searched another position
+    EXPECT_EQ(solver.findBestMove(won), Move(9, 7));
+    EXPECT_EQ(solver.getPonderMove(next), reply);
+}
+
+TEST(Solver, NullWindow)
+{
+    Position pos = openingPosition();
+    pos.play(8, 6, true);
+    pos.setIsMyTurn(true);
+
+    // without pruning, a null window search tells on which side of it the full window score is, each on a fresh table
+    auto search = [&pos](int alpha, int beta) {
+        Solver solver(15, 15, 0, 30000);
+        solver.setLMR(false);
+        solver.setNullMove(false);
+        solver.setProbCut(false);
+        SearchThread thread(0, pos, candidateRootMoves(pos));
+        int score = solver.negamax(thread, 4, 0, alpha, beta, true);
+        EXPECT_EQ(thread.pos, pos);
+        return score;
+    };
+    int score = search(-SCORE_INFINITY, SCORE_INFINITY);
+    EXPECT_GE(search(score - 1, score), score);
+    EXPECT_LE(search(score, score + 1), score);
+}
+
+TEST(Solver, AspirationWindow)
+{
+    Position pos = openingPosition();
+    pos.play(8, 6, true);
+    pos.setIsMyTurn(true);
+
+    // a root search in a window, on a fresh table, and its best move
+    auto search = [&pos](int alpha, int beta, Move &move) {
+        Solver solver(15, 15, 0, 30000);
+        solver.setLMR(false);
+        solver.setNullMove(false);
+        solver.setProbCut(false);
+        SearchThread thread(0, pos, candidateRootMoves(pos));
+        int score = solver.searchRoot(thread, 3, alpha, beta);
+        move = thread.rootMoves.front().move;
+        return score;
+    };
+    Move fullMove;
+    int score = search(-SCORE_INFINITY, SCORE_INFINITY, fullMove);
+
+    // a window around the score finds the same move and score
+    Move move;
+    EXPECT_EQ(search(score - ASPIRATION_WINDOW, score + ASPIRATION_WINDOW, move), score);
+    EXPECT_EQ(move, fullMove);
+
+    // a window above the score fails low, the search again with the low bound widened finds them back
+    int alpha = score + 1;
+    EXPECT_LE(search(alpha, alpha + ASPIRATION_WINDOW, move), alpha);
+    EXPECT_EQ(search(alpha - 2 * ASPIRATION_WINDOW, alpha + ASPIRATION_WINDOW, move), score);
+    EXPECT_EQ(move, fullMove);
+}
+
+TEST(Solver, CutoffOrdering)
+{
+    Position pos = openingPosition();
+
+    // the moves making a cutoff become the killers of their ply and gain history for the next nodes
+    Solver solver(15, 15, 0, 30000);
+    SearchThread thread(0, pos, candidateRootMoves(pos));
+    solver.negamax(thread, 3, 0, -SCORE_INFINITY, SCORE_INFINITY, true);
+    Move killer = thread.killers[1][0];
+    ASSERT_NE(killer, Move(-1, -1));
+    EXPECT_GT(thread.history[1][killer.first + killer.second * MAX_BOARD_SIZE], 0);
+}
+
+TEST(Solver, PonderAbort)
+{
+    Position pos = openingPosition();
+
+    // a ponder search has a full turn once the opponent moves, it is stopped at once by abort()
+    Solver solver(15, 15, 0, 30000);
+    solver.startPonder(pos);
+    std::future<Move> move = std::async(std::launch::async, [&]() { return solver.findBestMove(pos); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(move.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+    solver.abort();
+    ASSERT_EQ(move.wait_for(std::chrono::milliseconds(1500)), std::future_status::ready);
+    Move ponderMove = move.get();
+    EXPECT_TRUE(pos.canPlay(ponderMove.first, ponderMove.second));
+    solver.stopPonder();
+}
+
+TEST(Solver, PonderHit)
+{
+    Position pos = openingPosition();
+
+    // the time of the turn does not run while pondering, it starts when the opponent plays the move pondered
+    Solver solver(15, 15, 0, 300);
+    solver.startPonder(pos);
+    std::future<Move> move = std::async(std::launch::async, [&]() { return solver.findBestMove(pos); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    EXPECT_EQ(move.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+    solver.ponderHit();
+    ASSERT_EQ(move.wait_for(std::chrono::milliseconds(2000)), std::future_status::ready);
+    Move bestMove = move.get();
+    EXPECT_TRUE(pos.canPlay(bestMove.first, bestMove.second));
+    solver.stopPonder();
+}
+
+TEST(Solver, PonderMove)
+{
+    Position pos = blockedFourPosition();
+
+    // nothing is known of the position yet
+    Solver solver(15, 15, 0, 200);
+    EXPECT_EQ(solver.getPonderMove(pos), Move(-1, -1));
+
+    // the expected reply is the best move the search stored
+    std::vector<RootMove> rootMoves = { { Move(9, 7), 0 } };
+    SearchThread thread(0, pos, rootMoves);
+    EXPECT_EQ(solver.negamax(thread, 1, 0, -SCORE_INFINITY, SCORE_INFINITY, false), SCORE_WIN);
+    EXPECT_EQ(solver.getPonderMove(pos), Move(9, 7));
+}
+
+TEST(Solver, Pruning)
+{
+    Position pos = openingPosition();
+    pos.play(8, 6, true);
+
+    // the reductions, the null moves and probcut can be switched off separately, the search plays a candidate either way
+    for (int flags = 0; flags < 8; flags++) {
+        Solver solver(15, 15, 0, 200);
+        solver.setLMR(flags & 1);
+        solver.setNullMove(flags & 2);
+        solver.setProbCut(flags & 4);
+        Move move = solver.findBestMove(pos);
+
+        EXPECT_TRUE(pos.getCandidates().test(pos.getIndex(move.first, move.second)));
+    }
+}
+
+TEST(Solver, PruningForcedWin)
+{
+    Position pos = crossingTwosPosition();
+
+    // a root search at a fixed depth, on a fresh table, with the reductions (1) and the null moves (2) switched on
+    auto search = [&pos](int flags, Move &move, int &nodeCount) {
+        Solver solver(15, 15, 0, 30000);
+        solver.setLMR(flags & 1);
+        solver.setNullMove(flags & 2);
+        solver.setProbCut(false);
+        SearchThread thread(0, pos, candidateRootMoves(pos));
+        int score = solver.searchRoot(thread, 5, -SCORE_INFINITY, SCORE_INFINITY);
+        move = thread.rootMoves.front().move;
+        nodeCount = thread.nodeCount;
+        return score;
+    };
+    Move fullMove;
+    int fullNodes;
+    EXPECT_EQ(search(0, fullMove, fullNodes), SCORE_WIN);
+
+    // each pruning, and both of them, still win with the same move, on fewer nodes
+    for (int flags : { 1, 2, 3 }) {
+        Move move;
+        int nodeCount;
+        EXPECT_EQ(search(flags, move, nodeCount), SCORE_WIN);
+        EXPECT_EQ(move, fullMove);
+        EXPECT_LT(nodeCount, fullNodes);
+    }
+}
+
+TEST(Solver, ProbCutLog)
+{
+    Position pos = openingPosition();
+
+    // the fitting mode logs the score pairs of the principal variation, three integers per line
+    std::string path = testing::TempDir() + "probcut_test.log";
+    std::remove(path.c_str());
+    Solver solver(15, 15, 0, 1000);
+    solver.setProbCutLog(path);
+    solver.findBestMove(pos);
+    solver.setProbCutLog("");
+
+    std::ifstream log(path);
+    int depth;
+    int shallowScore;
+    int deepScore;
+    ASSERT_TRUE(log >> depth >> shallowScore >> deepScore);
+    EXPECT_GE(depth, PROBCUT_MIN_DEPTH);
+    std::remove(path.c_str());
+}
+
+TEST(Solver, Quiescence)
+{
+    Position pos = fourThenOpenFourPosition();
+
+    Solver solver(15, 15, 0, 200);
+    std::vector<RootMove> rootMoves = { { Move(7, 5), 0 } };
+    SearchThread thread(0, pos, rootMoves);
+
+    // the four and its block are played before the heuristic, then the open four wins
+    EXPECT_LT(solver.quiescence(thread, 0, -SCORE_INFINITY, SCORE_INFINITY), SCORE_WIN);
+    EXPECT_EQ(solver.quiescence(thread, 2, -SCORE_INFINITY, SCORE_INFINITY), SCORE_WIN);
+    EXPECT_EQ(thread.pos, pos);
+}
+}
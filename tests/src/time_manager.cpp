@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "ppay/time_manager.hpp"
+
+namespace gmk::ppay {
+
+TEST(TimeManager, TurnLimitOnly)
+{
+    TimeManager time(5000);
+    time.startTurn(20);
+    EXPECT_EQ(time.getSoftTime(), 5000u - TIMEOUT_TURN_LIMIT);
+    EXPECT_EQ(time.getHardTime(), 5000u - TIMEOUT_TURN_LIMIT);
+    EXPECT_FALSE(time.shouldStop(1, false, 0));
+
+    // playing as fast as possible still leaves a few ms
+    time.setTurnTime(0);
+    time.startTurn(20);
+    EXPECT_EQ(time.getHardTime(), static_cast<std::uint32_t>(MIN_TURN_TIME - TIMEOUT_TURN_LIMIT));
+
+    // a short turn limit is kept, not raised to the time of the fastest play
+    time.setTurnTime(50);
+    time.startTurn(20);
+    EXPECT_EQ(time.getHardTime(), 50u - TIMEOUT_TURN_LIMIT);
+    time.setTurnTime(TIMEOUT_TURN_LIMIT / 2);
+    time.startTurn(20);
+    EXPECT_EQ(time.getHardTime(), 1u);
+}
+
+TEST(TimeManager, MatchLimit)
+{
+    TimeManager time(30000);
+    time.setMatchTime(180000);
+
+    // the match time left is shared between the moves expected to be left
+    time.setTimeLeft(100200);
+    time.startTurn(20);
+    EXPECT_EQ(time.getSoftTime(), 100000u / ((EXPECTED_GAME_MOVES - 20) / 2));
+    EXPECT_GE(time.getHardTime(), time.getSoftTime());
+    EXPECT_LE(time.getHardTime(), 100000u / MAX_MATCH_TIME_DIVISOR);
+
+    // late in the game, the moves left are not guessed below the minimum
+    time.startTurn(EXPECTED_GAME_MOVES + 50);
+    EXPECT_EQ(time.getSoftTime(), 100000u / MIN_MOVES_LEFT);
+
+    // the turn limit is never exceeded
+    time.setTimeLeft(1000000);
+    time.startTurn(20);
+    EXPECT_EQ(time.getHardTime(), 30000u - TIMEOUT_TURN_LIMIT);
+
+    // with almost no time left, the move is played at once
+    time.setTimeLeft(MATCH_TIME_RESERVE / 2);
+    time.startTurn(20);
+    EXPECT_EQ(time.getHardTime(), 0u);
+    EXPECT_EQ(time.getRemainingTime(), 0u);
+    EXPECT_TRUE(time.shouldStop(1, false, 0));
+}
+
+TEST(TimeManager, Deadline)
+{
+    TimeManager time(5000);
+    time.startTurn(20);
+    EXPECT_FALSE(Deadline(1000, &time).isPassed());
+    EXPECT_TRUE(Deadline(0, &time).isPassed());
+
+    // a search given more time than the turn has left stops with the turn
+    time.setMatchTime(180000);
+    time.setTimeLeft(MATCH_TIME_RESERVE / 2);
+    time.startTurn(20);
+    EXPECT_TRUE(Deadline(1000, &time).isPassed());
+    EXPECT_FALSE(Deadline(1000, nullptr).isPassed());
+}
+}
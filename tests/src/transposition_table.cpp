@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "ppay/transposition_table.hpp"
+
+namespace gmk::ppay {
+
+TEST(TranspositionTable, SetGet)
+{
+    TranspositionTable tt(1024 * 1024);
+    TTEntry entry;
+
+    EXPECT_FALSE(tt.probe(42, entry));
+    tt.store(42, 1234, 3, TTBound::lower, 57);
+    EXPECT_TRUE(tt.probe(42, entry));
+    EXPECT_EQ(entry.value, 1234);
+    EXPECT_EQ(entry.depth, 3);
+    EXPECT_EQ(entry.bound(), TTBound::lower);
+    EXPECT_EQ(entry.move, 57);
+
+    tt.clear();
+    EXPECT_FALSE(tt.probe(42, entry));
+}
+
+TEST(TranspositionTable, MemoryLimit)
+{
+    TranspositionTable tt(1024 * 1024);
+    EXPECT_LE(tt.capacity() * sizeof(TTEntry), 1024u * 1024u);
+    EXPECT_GT(tt.capacity() * sizeof(TTEntry), 512u * 1024u);
+
+    tt.resize(1000);
+    EXPECT_LE(tt.capacity() * sizeof(TTEntry), 1000u);
+}
+
+TEST(TranspositionTable, DepthPreferred)
+{
+    // a single bucket
+    TranspositionTable tt(sizeof(TTBucket));
+    TTEntry entry;
+
+    tt.store(1, 10, 8, TTBound::exact, -1);
+    tt.store(2, 20, 7, TTBound::exact, -1);
+    tt.store(3, 30, 6, TTBound::exact, -1);
+    // the depth-preferred entries are full of deeper results
+    tt.store(4, 40, 1, TTBound::exact, -1);
+    tt.store(5, 50, 2, TTBound::exact, -1);
+
+    EXPECT_TRUE(tt.probe(1, entry));
+    EXPECT_TRUE(tt.probe(2, entry));
+    EXPECT_TRUE(tt.probe(3, entry));
+    EXPECT_FALSE(tt.probe(4, entry));
+    EXPECT_TRUE(tt.probe(5, entry));
+    EXPECT_EQ(entry.value, 50);
+
+    // a deeper result replaces the shallowest one
+    tt.store(6, 60, 9, TTBound::exact, -1);
+    EXPECT_TRUE(tt.probe(6, entry));
+    EXPECT_FALSE(tt.probe(3, entry));
+}
+
+TEST(TranspositionTable, Generation)
+{
+    // a single bucket
+    TranspositionTable tt(sizeof(TTBucket));
+    TTEntry entry;
+
+    tt.store(1, 10, 8, TTBound::exact, -1);
+    tt.store(2, 20, 7, TTBound::exact, -1);
+    tt.store(3, 30, 6, TTBound::exact, -1);
+
+    // entries of the previous searches are kept
+    tt.newSearch();
+    EXPECT_TRUE(tt.probe(1, entry));
+    EXPECT_EQ(entry.generation(), 0);
+
+    // but are replaced by shallower results of the new search
+    tt.newSearch();
+    tt.store(4, 40, 2, TTBound::exact, -1);
+    EXPECT_TRUE(tt.probe(4, entry));
+    EXPECT_EQ(entry.generation(), 2);
+    EXPECT_FALSE(tt.probe(3, entry));
+    EXPECT_TRUE(tt.probe(1, entry));
+}
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "ppay/vcf.hpp"
+
+#include "fixtures.hpp"
+
+namespace gmk::ppay {
+
+TEST(VCF, ContinuousFours)
+{
+    Position pos = fourThenOpenFourPosition();
+    Position initial(pos);
+    VCFSolver vcf;
+    Move move;
+
+    EXPECT_FALSE(pos.getThreatCells(true, ThreatType::five).any());
+    EXPECT_FALSE(pos.getThreatCells(true, ThreatType::openFour).any());
+
+    // one four is not enough
+    EXPECT_FALSE(vcf.solve(pos, 1, 1000, move));
+    EXPECT_TRUE(vcf.solve(pos, 2, 1000, move));
+    EXPECT_EQ(move, Move(7, 5));
+    EXPECT_EQ(pos, initial);
+}
+
+TEST(VCF, Defender)
+{
+    Position pos = fourThenOpenFourPosition();
+    VCFSolver vcf;
+    Move move;
+
+    // the opponent has no four to play
+    pos.setIsMyTurn(false);
+    EXPECT_FALSE(vcf.solve(pos, VCF_MAX_DEPTH, 1000, move));
+
+    // a four of the opponent must be blocked first, here without making a four
+    pos.play(9, 10, true);
+    pos.play(10, 10, false);
+    pos.play(11, 10, false);
+    pos.play(12, 10, false);
+    pos.play(13, 10, false);
+    pos.setIsMyTurn(true);
+    EXPECT_FALSE(vcf.solve(pos, VCF_MAX_DEPTH, 1000, move));
+}
+}
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "ppay/vcf.hpp"
+#include "ppay/vct.hpp"
+
+#include "fixtures.hpp"
+
+namespace gmk::ppay {
+
+TEST(VCT, DoubleThree)
+{
+    Position pos = crossingTwosPosition();
+    Position initial(pos);
+
+    VCFSolver vcf;
+    VCTSolver vct;
+    Move move;
+
+    EXPECT_FALSE(vcf.solve(pos, VCF_MAX_DEPTH, 1000, move));
+    EXPECT_TRUE(vct.solve(pos, VCT_MAX_DEPTH, 1000, move));
+    EXPECT_EQ(pos, initial);
+
+    // the opponent has nothing
+    pos.setIsMyTurn(false);
+    EXPECT_FALSE(vct.solve(pos, VCT_MAX_DEPTH, 1000, move));
+}
+
+TEST(VCT, OpponentThree)
+{
+    Position pos(15, 15);
+
+    // an open three of the opponent is faster than our threes
+    pos.play(7, 7, true);
+    pos.play(8, 7, true);
+    pos.play(9, 4, true);
+    pos.play(9, 5, true);
+    pos.play(3, 10, false);
+    pos.play(4, 10, false);
+    pos.play(5, 10, false);
+    pos.setIsMyTurn(true);
+
+    VCTSolver vct;
+    Move move;
+    EXPECT_FALSE(vct.solve(pos, VCT_MAX_DEPTH, 1000, move));
+}
+}